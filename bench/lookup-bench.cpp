@@ -0,0 +1,111 @@
+// Per-frame overlay lookup cost: string-keyed unordered containers
+// (contains() + operator[], as the state used to do) versus FlatMap
+// keyed by WindowHandle. Each simulated frame performs the scroll,
+// volume and mute lookups for every window from all three call sites
+// (draw, renderPass, getVisualBox).
+
+#include "flat-map.hpp"
+#include "types.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+constexpr int CALL_SITES = 3;
+constexpr int FRAMES = 2000;
+
+volatile size_t g_sink;
+
+struct Event {
+  int level = 0;
+};
+
+std::vector<WindowHandle> makeWindows(size_t count) {
+  std::vector<WindowHandle> windows;
+  // Heap-like addresses: 16-byte aligned, spread over a few MB.
+  for (size_t i = 0; i < count; ++i) {
+    windows.push_back(0x55d0c0000000ull + i * 0x1a40);
+  }
+  return windows;
+}
+
+template <typename Fn>
+double nsPerFrame(Fn&& frame) {
+  frame();  // Warm up
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < FRAMES; ++i) frame();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         FRAMES;
+}
+
+double benchStringKeys(const std::vector<WindowHandle>& windows) {
+  std::unordered_map<std::string, std::vector<Event>> volume;
+  std::unordered_map<std::string, Event> anchors;
+  std::unordered_set<std::string> muted;
+  std::vector<std::string> addresses;
+
+  for (size_t i = 0; i < windows.size(); ++i) {
+    char address[32];
+    std::snprintf(address, sizeof(address), "0x%lx", (unsigned long)windows[i]);
+    addresses.push_back(address);
+    if (i % 3 == 0) volume[addresses.back()].push_back({50});
+    if (i % 7 == 0) anchors[addresses.back()] = {};
+    if (i % 5 == 0) muted.insert(addresses.back());
+  }
+
+  return nsPerFrame([&] {
+    size_t found = 0;
+    for (const auto& address : addresses) {
+      for (int site = 0; site < CALL_SITES; ++site) {
+        if (anchors.contains(address)) found += anchors[address].level;
+        if (volume.contains(address)) found += volume[address].size();
+        if (muted.contains(address)) ++found;
+      }
+    }
+    g_sink = found;
+  });
+}
+
+double benchFlatMap(const std::vector<WindowHandle>& windows) {
+  FlatMap<WindowHandle, std::vector<Event>> volume;
+  FlatMap<WindowHandle, Event> anchors;
+  FlatSet<WindowHandle> muted;
+
+  for (size_t i = 0; i < windows.size(); ++i) {
+    if (i % 3 == 0) volume[windows[i]].push_back({50});
+    if (i % 7 == 0) anchors[windows[i]] = {};
+    if (i % 5 == 0) muted.insert(windows[i]);
+  }
+
+  return nsPerFrame([&] {
+    size_t found = 0;
+    for (WindowHandle window : windows) {
+      for (int site = 0; site < CALL_SITES; ++site) {
+        if (auto* anchor = anchors.find(window)) found += anchor->level;
+        if (auto* events = volume.find(window)) found += events->size();
+        if (muted.contains(window)) ++found;
+      }
+    }
+    g_sink = found;
+  });
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%8s %16s %16s %8s\n",
+              "windows", "string ns/frame", "flat ns/frame", "speedup");
+  for (size_t count : {10, 40, 100, 1000}) {
+    auto windows = makeWindows(count);
+    double before = benchStringKeys(windows);
+    double after = benchFlatMap(windows);
+    std::printf("%8zu %16.0f %16.0f %7.1fx\n",
+                count, before, after, before / after);
+  }
+  return 0;
+}
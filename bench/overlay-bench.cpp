@@ -0,0 +1,315 @@
+// Hot paths of the command and overlay pipeline, run on the plugin's
+// own parser, model and texture cache outside the compositor:
+//
+//   parse     text commands parsed into records, commands/s
+//   snapshot  buildSnapshot() plus the primitive walk for every
+//             window, as one frame of decorations does it
+//   damage    a burst of updates applied and the dirty set drained,
+//             as one batch from a client does it
+//   lookup    TextureCache::region() for built-in and interned icons
+//
+// Pass --json for one JSON object per result instead of the table.
+
+#include "clock.hpp"
+#include "command-parser.hpp"
+#include "overlay-model.hpp"
+#include "settings.hpp"
+#include "texture-cache.hpp"
+#include <cairo/cairo.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+constexpr int FRAMES = 2000;
+constexpr int PARSE_ROUNDS = 200;
+constexpr int DYNAMIC_ICONS = 16;
+
+volatile size_t g_sink;
+bool g_json = false;
+
+using Steady = std::chrono::steady_clock;
+
+void report(const char* bench, size_t windows, const char* unit,
+            double value) {
+  if (g_json) {
+    std::printf("{\"bench\":\"%s\",\"windows\":%zu,\"unit\":\"%s\","
+                "\"value\":%.1f}\n",
+                bench, windows, unit, value);
+  } else {
+    std::printf("%-10s %8zu %14.1f %s\n", bench, windows, value, unit);
+  }
+}
+
+std::vector<WindowHandle> makeWindows(size_t count) {
+  std::vector<WindowHandle> windows;
+  // Heap-like addresses: 16-byte aligned, spread over a few MB.
+  for (size_t i = 0; i < count; ++i) {
+    windows.push_back(0x55d0c0000000ull + i * 0x1a40);
+  }
+  return windows;
+}
+
+std::string hex(WindowHandle window) {
+  char address[32];
+  std::snprintf(address, sizeof(address), "%lx", (unsigned long)window);
+  return address;
+}
+
+template <typename Fn>
+double nsPerFrame(Fn&& frame) {
+  frame();  // Warm up
+  auto start = Steady::now();
+  for (int i = 0; i < FRAMES; ++i) frame();
+  auto end = Steady::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         FRAMES;
+}
+
+OverlayCommand command(CommandOp op, WindowHandle window, int32_t level) {
+  OverlayCommand cmd;
+  cmd.op = op;
+  cmd.window = window;
+  cmd.level = level;
+  return cmd;
+}
+
+OverlayCommand setField(uint32_t id, PrimitiveField field, double value) {
+  OverlayCommand cmd = command(CommandOp::PRIM_SET, 0, id);
+  cmd.flags = (uint16_t)field;
+  cmd.x = value;
+  return cmd;
+}
+
+// Fills a model the way a busy session looks as of the clock's now: a
+// third of the windows showing volume (some of them mid-fade), anchors,
+// mutes, and a progress bar on every fourth.
+void populate(
+    OverlayModel& model,
+    ManualClock& clock,
+    const std::vector<WindowHandle>& windows) {
+  auto now = clock.now();
+  const auto& volume = settings::forType(OverlayType::VOLUME_LEVEL);
+  for (size_t i = 0; i < windows.size(); ++i) {
+    WindowHandle window = windows[i];
+    if (i % 3 == 0) {
+      // Every other one started long enough ago to be fading.
+      auto age = std::chrono::milliseconds(
+          i % 2 ? volume.displayMs + volume.fadeMs / 2 : 0);
+      clock.set(now - age);
+      model.apply(command(CommandOp::VOLUME_UP, window, 40 + i % 60));
+      clock.set(now);
+    }
+    if (i % 7 == 0) {
+      OverlayCommand anchor = command(CommandOp::SCROLL_START, window, 0);
+      anchor.x = 100;
+      anchor.y = 200;
+      model.apply(anchor);
+    }
+    if (i % 5 == 0) model.apply(command(CommandOp::MUTE_ADD, window, 0));
+    if (i % 4 == 0) {
+      uint32_t id = i + 1;
+      OverlayCommand create = command(CommandOp::PRIM_CREATE, window, id);
+      create.flags = (uint16_t)PrimitiveKind::PROGRESS;
+      model.apply(create);
+      model.apply(setField(id, PrimitiveField::VALUE, 0.5));
+    }
+  }
+  model.dirtyWindows().clear();
+}
+
+void benchParse() {
+  OverlayModel model(Clock::steady(), nullptr, nullptr);
+  // No log hook: the plugin logs every command to a file, which
+  // would dominate.
+  CommandParser parser({
+      [](std::string_view name) {
+        return TextureCache::get().intern(std::string(name));
+      },
+      [&model](std::string text) { return model.storeText(std::move(text)); },
+      nullptr,
+  });
+
+  auto windows = makeWindows(64);
+  std::string content;
+  size_t lines = 0;
+  for (size_t i = 0; i < windows.size(); ++i) {
+    std::string addr = hex(windows[i]);
+    std::string id = std::to_string(i + 1);
+    content += "vol-up " + addr + " " + std::to_string(i % 100) + "\n";
+    content += "scroll-start " + addr + " 120.5 300\n";
+    content += "create " + id + " " + addr + " progress x=10 y=10 w=120 "
+               "h=8 value=0.42 color=#ff8800\n";
+    content += "update " + id + " value=0.5 icon=app" +
+               std::to_string(i % DYNAMIC_ICONS) + "\n";
+    content += "update " + id + " text=CPU 42%\n";
+    content += "scroll-stop " + addr + "\n";
+    lines += 6;
+  }
+
+  size_t records = 0;
+  // Labels are freed as the plugin would on applying them.
+  auto sink = [&records, &model](const OverlayCommand& command, TraceId) {
+    model.releaseText(command);
+    ++records;
+  };
+  parser.parse(content, sink);  // Warm up
+
+  auto start = Steady::now();
+  for (int i = 0; i < PARSE_ROUNDS; ++i) parser.parse(content, sink);
+  double seconds =
+      std::chrono::duration<double>(Steady::now() - start).count();
+  g_sink = records;
+
+  report("parse", 0, "commands/s", lines * PARSE_ROUNDS / seconds);
+}
+
+void benchSnapshot(size_t count) {
+  auto windows = makeWindows(count);
+  ManualClock clock(Steady::now());
+  OverlayModel model(clock, nullptr, nullptr);
+  populate(model, clock, windows);
+  auto now = clock.now();
+
+  OverlaySnapshot snapshot;
+  double ns = nsPerFrame([&] {
+    size_t found = 0;
+    for (WindowHandle window : windows) {
+      model.buildSnapshot(window, now, snapshot);
+      found += snapshot.count;
+      model.forEachPrimitive(window, now, [&found](const Primitive& prim) {
+        found += prim.kind == PrimitiveKind::PROGRESS;
+      });
+    }
+    g_sink = found;
+  });
+  report("snapshot", count, "ns/frame", ns);
+}
+
+void benchDamage(size_t count) {
+  auto windows = makeWindows(count);
+  ManualClock clock(Steady::now());
+  OverlayModel model(clock, nullptr, nullptr);
+  populate(model, clock, windows);
+
+  std::vector<WindowHandle> damaged;
+  double value = 0;
+  double ns = nsPerFrame([&] {
+    value = value >= 1.0 ? 0.0 : value + 0.01;
+    for (size_t i = 0; i < windows.size(); i += 4) {
+      model.apply(setField(i + 1, PrimitiveField::VALUE, value));
+    }
+    for (size_t i = 0; i < windows.size(); i += 3) {
+      model.apply(command(CommandOp::VOLUME_LEVEL, windows[i], 50));
+    }
+
+    damaged.clear();
+    auto& dirty = model.dirtyWindows();
+    dirty.forEach([&damaged](WindowHandle window, bool) {
+      damaged.push_back(window);
+    });
+    dirty.clear();
+    g_sink = damaged.size();
+  });
+  report("damage", count, "ns/frame", ns);
+}
+
+bool writeIcon(const std::string& path) {
+  cairo_surface_t* surface =
+      cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 32, 32);
+  cairo_t* cr = cairo_create(surface);
+  cairo_set_source_rgba(cr, 1, 1, 1, 0.8);
+  cairo_arc(cr, 16, 16, 12, 0, 6.2832);
+  cairo_fill(cr);
+  cairo_destroy(cr);
+  bool ok = cairo_surface_write_to_png(surface, path.c_str()) ==
+            CAIRO_STATUS_SUCCESS;
+  cairo_surface_destroy(surface);
+  return ok;
+}
+
+// Writes an icon set into a scratch directory and points the settings
+// at it. Must run before anything touches the texture cache.
+std::filesystem::path installIcons() {
+  auto dir = std::filesystem::temp_directory_path() /
+             ("superglue-bench-" + std::to_string(getpid()));
+  std::filesystem::create_directories(dir);
+
+  auto table = settings::defaults(dir.string());
+  for (const auto& path : table.iconPaths) {
+    if (!path.empty()) writeIcon(path);
+  }
+  for (int i = 0; i < DYNAMIC_ICONS; ++i) {
+    writeIcon((dir / ("app" + std::to_string(i) + ".png")).string());
+  }
+  settings::install(std::move(table));
+  TextureCache::get().setIconDir(dir.string());
+  return dir;
+}
+
+void benchLookup() {
+  auto& cache = TextureCache::get();
+  std::vector<IconId> icons;
+  for (size_t i = (size_t)IconId::NONE + 1; i < (size_t)IconId::COUNT; ++i) {
+    icons.push_back((IconId)i);
+  }
+  for (int i = 0; i < DYNAMIC_ICONS; ++i) {
+    icons.push_back(cache.intern("app" + std::to_string(i)));
+  }
+
+  // Decodes run on the pool; wait for all of them to land.
+  for (IconId icon : icons) cache.prefetch(icon);
+  auto deadline = Steady::now() + std::chrono::seconds(5);
+  size_t ready = 0;
+  while (Steady::now() < deadline) {
+    cache.uploadPending();
+    ready = 0;
+    for (IconId icon : icons) ready += cache.region(icon) != nullptr;
+    if (ready == icons.size()) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  if (ready != icons.size()) {
+    std::fprintf(stderr, "lookup: only %zu of %zu icons decoded\n",
+                 ready, icons.size());
+    return;
+  }
+
+  double ns = nsPerFrame([&] {
+    cache.beginFrame();
+    size_t found = 0;
+    for (IconId icon : icons) {
+      if (const TextureRegion* region = cache.region(icon)) {
+        found += (size_t)region->size.x;
+      }
+    }
+    g_sink = found;
+  });
+  report("lookup", 0, "ns/icon", ns / icons.size());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--json") == 0) g_json = true;
+  }
+
+  auto iconDir = installIcons();
+
+  if (!g_json) {
+    std::printf("%-10s %8s %14s %s\n", "bench", "windows", "value", "unit");
+  }
+  benchParse();
+  for (size_t count : {1, 10, 100, 1000}) benchSnapshot(count);
+  for (size_t count : {1, 10, 100, 1000}) benchDamage(count);
+  benchLookup();
+
+  std::filesystem::remove_all(iconDir);
+  return 0;
+}
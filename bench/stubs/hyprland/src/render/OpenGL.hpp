@@ -0,0 +1,46 @@
+#pragma once
+
+// Just enough of Hyprland's render types for texture-cache.cpp and
+// render-utils.hpp to compile into the benchmarks. Nothing here
+// touches a GL context; see stubs.cpp.
+
+#include <GLES3/gl32.h>
+#include <memory>
+#include <vector>
+
+template <typename T>
+using SP = std::shared_ptr<T>;
+
+template <typename T, typename... Args>
+SP<T> makeShared(Args&&... args) {
+  return std::make_shared<T>(std::forward<Args>(args)...);
+}
+
+struct Vector2D {
+  double x = 0, y = 0;
+  bool operator==(const Vector2D& other) const = default;
+};
+
+struct CBox {
+  double x = 0, y = 0, w = 0, h = 0;
+};
+
+class CTexture {
+ public:
+  GLuint m_texID = 0;
+};
+
+struct CStubRegion {
+  std::vector<CBox> getRects() const { return {}; }
+};
+
+class CHyprOpenGLImpl {
+ public:
+  struct {
+    CStubRegion damage;
+  } m_renderData;
+
+  void scissor(const CBox*) {}
+};
+
+inline CHyprOpenGLImpl* g_pHyprOpenGL = nullptr;
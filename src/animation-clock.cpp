@@ -0,0 +1,38 @@
+#include "animation-clock.hpp"
+#include <algorithm>
+
+static int handleTimer(void* data) {
+  return ((AnimationClock*)data)->onTimer();
+}
+
+AnimationClock::AnimationClock(wl_event_loop* loop, Tick tick)
+    : m_tick(std::move(tick)) {
+  m_source = wl_event_loop_add_timer(loop, handleTimer, this);
+}
+
+AnimationClock::~AnimationClock() {
+  if (m_source) wl_event_source_remove(m_source);
+}
+
+void AnimationClock::wakeAt(TimePoint when) {
+  if (!m_source) return;
+  if (m_deadline && *m_deadline <= when) return;
+  m_deadline = when;
+
+  // The event loop timer has millisecond resolution and treats 0 as
+  // disarm, so round up and fire no sooner than 1 ms from now.
+  auto delay = std::chrono::ceil<std::chrono::milliseconds>(
+      when - std::chrono::steady_clock::now()).count();
+  wl_event_source_timer_update(m_source, std::max<int>(1, delay));
+}
+
+void AnimationClock::cancel() {
+  if (m_source) wl_event_source_timer_update(m_source, 0);
+  m_deadline.reset();
+}
+
+int AnimationClock::onTimer() {
+  m_deadline.reset();
+  m_tick();
+  return 0;
+}
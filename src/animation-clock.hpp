@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <wayland-server.h>
+
+/**
+ * One-shot wakeup on the compositor event loop.
+ * Owners ask to be woken at the next moment something on screen
+ * changes; with nothing scheduled the timer stays disarmed.
+ */
+class AnimationClock {
+ public:
+  using Tick = std::function<void()>;
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  AnimationClock(wl_event_loop* loop, Tick tick);
+  ~AnimationClock();
+
+  /**
+   * Arms the timer for when, unless an earlier wakeup is pending.
+   */
+  void wakeAt(TimePoint when);
+
+  /**
+   * Disarms the timer.
+   */
+  void cancel();
+
+  /**
+   * Runs the tick after the timer fired.
+   */
+  int onTimer();
+
+ private:
+  wl_event_source* m_source = nullptr;
+  Tick m_tick;
+  std::optional<TimePoint> m_deadline;
+};
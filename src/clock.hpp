@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+
+/**
+ * Source of the current time for overlay timing.
+ *
+ * The model asks its clock rather than std::chrono directly, so fades
+ * and expiry can be driven by a ManualClock outside the compositor.
+ */
+class Clock {
+ public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  virtual ~Clock() = default;
+  virtual TimePoint now() const = 0;
+
+  /**
+   * Returns the process-wide monotonic clock.
+   */
+  static const Clock& steady();
+};
+
+class SteadyClock : public Clock {
+ public:
+  TimePoint now() const override { return std::chrono::steady_clock::now(); }
+};
+
+inline const Clock& Clock::steady() {
+  static const SteadyClock instance;
+  return instance;
+}
+
+/**
+ * A clock that only moves when told to.
+ */
+class ManualClock : public Clock {
+ public:
+  explicit ManualClock(TimePoint start = {}) : m_now(start) {}
+
+  TimePoint now() const override { return m_now; }
+  void set(TimePoint when) { m_now = when; }
+  void advance(std::chrono::steady_clock::duration by) { m_now += by; }
+
+ private:
+  TimePoint m_now;
+};
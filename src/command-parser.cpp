@@ -0,0 +1,279 @@
+#include "command-parser.hpp"
+#include "perfect-hash.hpp"
+#include "primitive.hpp"
+#include "metrics.hpp"
+#include <charconv>
+#include <type_traits>
+
+// Splits the next space- or tab-separated token off rest.
+static bool nextToken(std::string_view& rest, std::string_view& token) {
+  size_t start = rest.find_first_not_of(" \t");
+  if (start == std::string_view::npos) {
+    rest = {};
+    return false;
+  }
+  size_t end = rest.find_first_of(" \t", start);
+  if (end == std::string_view::npos) end = rest.size();
+  token = rest.substr(start, end - start);
+  rest.remove_prefix(end);
+  return true;
+}
+
+// Parses all of token as a number; partial matches are malformed.
+template <typename T>
+static bool parseNumber(std::string_view token, T& out, int base = 10) {
+  // from_chars takes no '+'; one before another sign is malformed.
+  if (token.size() > 1 && token[0] == '+' && token[1] != '+' &&
+      token[1] != '-') {
+    token.remove_prefix(1);
+  }
+  const char* end = token.data() + token.size();
+  std::from_chars_result result;
+  if constexpr (std::is_floating_point_v<T>) {
+    result = std::from_chars(token.data(), end, out);
+  } else {
+    result = std::from_chars(token.data(), end, out, base);
+  }
+  return !token.empty() && result.ec == std::errc() && result.ptr == end;
+}
+
+static bool parseColor(std::string_view value, uint32_t& out) {
+  // #rrggbb or #rrggbbaa; a missing alpha means opaque.
+  if (value.empty() || value[0] != '#') return false;
+  size_t digits = value.size() - 1;
+  if (digits != 6 && digits != 8) return false;
+
+  uint32_t rgba = 0;
+  if (!parseNumber(value.substr(1), rgba, 16)) return false;
+  out = digits == 6 ? (rgba << 8) | 0xff : rgba;
+  return true;
+}
+
+CommandParser::CommandParser(Hooks hooks) : m_hooks(std::move(hooks)) {}
+
+const CommandParser::Verb* CommandParser::findVerb(std::string_view name) {
+  static constexpr perfect_hash::Table<Verb, 16> VERBS({
+      {"create", {&CommandParser::parsePrimitive, CommandOp::PRIM_CREATE}},
+      {"update", {&CommandParser::parsePrimitive, CommandOp::PRIM_SET}},
+      {"destroy", {&CommandParser::parsePrimitive, CommandOp::PRIM_DESTROY}},
+      {"scroll-start", {&CommandParser::parseScroll, CommandOp::SCROLL_START}},
+      {"scroll-stop", {&CommandParser::parseScroll, CommandOp::SCROLL_STOP}},
+      {"vol-up", {&CommandParser::parseVolume, CommandOp::VOLUME_UP}},
+      {"vol-down", {&CommandParser::parseVolume, CommandOp::VOLUME_DOWN}},
+  });
+  return VERBS.find(name);
+}
+
+// Strips a leading @seq or @seq:sentUs tag off line and starts its
+// trace; trace stays 0 if the line is untagged. Returns false if the
+// tag is malformed.
+static bool beginTrace(
+    std::string_view& line,
+    std::chrono::steady_clock::time_point& read,
+    TraceId& trace) {
+  size_t start = line.find_first_not_of(" \t");
+  if (line[start] != '@') return true;
+
+  std::string_view tag;
+  nextToken(line, tag);
+  tag.remove_prefix(1);
+  size_t colon = tag.find(':');
+
+  uint64_t seq = 0;
+  int64_t sentUs = 0;
+  if (!parseNumber(tag.substr(0, colon), seq)) return false;
+  if (colon != std::string_view::npos &&
+      !parseNumber(tag.substr(colon + 1), sentUs)) {
+    return false;
+  }
+
+  // One read time for the whole batch, sampled on the first tag.
+  if (read == std::chrono::steady_clock::time_point{}) {
+    read = std::chrono::steady_clock::now();
+  }
+  trace = LatencyTracer::get().begin(seq, sentUs, read);
+  return true;
+}
+
+void CommandParser::parse(std::string_view content, const Sink& sink) const {
+  std::chrono::steady_clock::time_point read{};
+  while (!content.empty()) {
+    size_t end = content.find('\n');
+    std::string_view line = content.substr(0, end);
+    content.remove_prefix(end == std::string_view::npos ? content.size()
+                                                        : end + 1);
+
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    if (line.find_first_not_of(" \t") == std::string_view::npos) continue;
+
+    // A bad tag rejects the line, so the client learns of it from
+    // the counts rather than through a trace that never shows up.
+    TraceId trace = 0;
+    if (!beginTrace(line, read, trace) ||
+        !parseLine(line, LineSink{sink, trace})) {
+      m_rejected.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+bool CommandParser::parseLine(
+    std::string_view line,
+    const LineSink& sink) const {
+  std::string_view name;
+  nextToken(line, name);
+
+  // Any other name followed by an address and a level shows the level
+  // without an arrow.
+  static constexpr Verb LEVEL = {
+      &CommandParser::parseVolume, CommandOp::VOLUME_LEVEL};
+  const Verb* verb = findVerb(name);
+  if (!verb) verb = &LEVEL;
+
+  if (!(this->*verb->handler)(verb->op, line, sink)) {
+    Metrics::get().commandRejected(verb->op);
+    return false;
+  }
+  return true;
+}
+
+bool CommandParser::parseScroll(
+    CommandOp op,
+    std::string_view args,
+    const LineSink& sink) const {
+  std::string_view addr, x, y;
+  OverlayCommand command;
+  command.op = op;
+  if (!nextToken(args, addr)) return false;
+  command.window = parseAddress(addr);
+  if (command.window == 0) return false;
+
+  if (op == CommandOp::SCROLL_START) {
+    if (!nextToken(args, x) || !nextToken(args, y) ||
+        !parseNumber(x, command.x) || !parseNumber(y, command.y)) {
+      return false;
+    }
+  }
+  sink(command);
+  return true;
+}
+
+bool CommandParser::parseVolume(
+    CommandOp op,
+    std::string_view args,
+    const LineSink& sink) const {
+  std::string_view addr, level;
+  if (!nextToken(args, addr) || !nextToken(args, level)) return false;
+
+  OverlayCommand command;
+  command.op = op;
+  command.window = parseAddress(addr);
+  if (command.window == 0 || !parseNumber(level, command.level)) return false;
+  sink(command);
+  return true;
+}
+
+bool CommandParser::parsePrimitive(
+    CommandOp op,
+    std::string_view args,
+    const LineSink& sink) const {
+  std::string_view token;
+  int32_t id = 0;
+  if (!nextToken(args, token) || !parseNumber(token, id) || id <= 0) {
+    return false;
+  }
+
+  OverlayCommand command;
+  command.op = op;
+  command.level = id;
+
+  if (op == CommandOp::PRIM_DESTROY) {
+    sink(command);
+    return true;
+  }
+
+  if (op == CommandOp::PRIM_CREATE) {
+    static constexpr perfect_hash::Table<PrimitiveKind, 16> KINDS({
+        {"icon", PrimitiveKind::ICON},
+        {"rect", PrimitiveKind::RECT},
+        {"line", PrimitiveKind::LINE},
+        {"text", PrimitiveKind::TEXT},
+        {"circle", PrimitiveKind::CIRCLE},
+        {"progress", PrimitiveKind::PROGRESS},
+    });
+
+    std::string_view addr, kindName;
+    if (!nextToken(args, addr) || !nextToken(args, kindName)) return false;
+    command.window = parseAddress(addr);
+    if (command.window == 0) return false;
+
+    const PrimitiveKind* kind = KINDS.find(kindName);
+    if (!kind) {
+      log("Unknown primitive kind: " + std::string(kindName));
+      return false;
+    }
+    command.flags = (uint16_t)*kind;
+    sink(command);
+  }
+
+  parseFields(id, args, sink);
+  return true;
+}
+
+void CommandParser::parseFields(
+    int32_t id,
+    std::string_view args,
+    const LineSink& sink) const {
+  // The rest of the line is key=value pairs, one PRIM_SET each, so
+  // an update only carries the fields that changed.
+  std::string_view token;
+  while (nextToken(args, token)) {
+    auto eq = token.find('=');
+    if (eq == std::string_view::npos) continue;
+
+    auto field = parsePrimitiveField(token.substr(0, eq));
+    std::string_view value = token.substr(eq + 1);
+    if (field == PrimitiveField::COUNT) {
+      log("Unknown primitive field: " + std::string(token));
+      continue;
+    }
+
+    OverlayCommand set;
+    set.op = CommandOp::PRIM_SET;
+    set.level = id;
+    set.flags = (uint16_t)field;
+    if (field == PrimitiveField::ICON) {
+      if (!m_hooks.internIcon) continue;
+      set.x = (double)m_hooks.internIcon(value);
+    } else if (field == PrimitiveField::TEXT) {
+      // Labels may contain spaces, so text takes the rest of the line.
+      if (!m_hooks.storeText) continue;
+      value = std::string_view(value.data(), args.data() + args.size());
+      args = {};
+      auto handle = m_hooks.storeText(std::string(value));
+      if (!handle) {
+        log("No room for primitive text, dropping: " + std::string(value));
+        continue;
+      }
+      set.x = *handle;
+    } else if (field == PrimitiveField::COLOR ||
+               field == PrimitiveField::BACKGROUND) {
+      uint32_t rgba = 0;
+      if (!parseColor(value, rgba)) continue;
+      set.x = rgba;
+    } else if (!parseNumber(value, set.x)) {
+      log("Bad value for primitive field: " + std::string(token));
+      continue;
+    }
+    sink(set);
+  }
+}
+
+WindowHandle CommandParser::parseAddress(std::string_view addr) {
+  if (addr.starts_with("0x") || addr.starts_with("0X")) addr.remove_prefix(2);
+  WindowHandle value = 0;
+  return parseNumber(addr, value, 16) ? value : 0;
+}
+
+void CommandParser::log(const std::string& msg) const {
+  if (m_hooks.log) m_hooks.log(msg);
+}
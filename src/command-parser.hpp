@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "types.hpp"
+#include "command.hpp"
+#include "latency-tracer.hpp"
+
+/**
+ * Turns newline-separated text commands into OverlayCommand records.
+ *
+ * Has no compositor dependency: whatever the records need from the
+ * outside (icon ids for names, storage for label strings, logging)
+ * comes in through hooks, so the same parser serves the socket, the
+ * command file and the benchmarks. parse() is const and may run on
+ * any thread the hooks are safe on.
+ *
+ * Tokens are views into the caller's buffer and numbers go through
+ * std::from_chars, so apart from the hooks a batch of any size parses
+ * without allocating.
+ *
+ * A line may start with `@<seq>` or `@<seq>:<monotonic µs>` to have
+ * the commands on it traced by LatencyTracer; their records reach
+ * the sink with the trace id. A line with a malformed tag is
+ * rejected.
+ */
+class CommandParser {
+ public:
+  using Sink = std::function<void(const OverlayCommand&, TraceId)>;
+
+  struct Hooks {
+    std::function<IconId(std::string_view)> internIcon;
+    // Returns the handle a TEXT record carries, or nothing if the
+    // label can't be kept.
+    std::function<std::optional<uint32_t>(std::string)> storeText;
+    std::function<void(const std::string&)> log;
+  };
+
+  explicit CommandParser(Hooks hooks);
+
+  /**
+   * Parses every line of content, handing each record to sink.
+   * Malformed lines are skipped and counted.
+   */
+  void parse(std::string_view content, const Sink& sink) const;
+
+  /**
+   * Returns how many lines have been rejected so far.
+   */
+  uint64_t rejected() const {
+    return m_rejected.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Parses a hex window address, with or without 0x. Returns 0 if
+   * malformed.
+   */
+  static WindowHandle parseAddress(std::string_view addr);
+
+ private:
+  // The sink bound to the trace of the line being parsed. A traced
+  // line counts as parsed once its first record is out, since socket
+  // sinks apply records as they arrive.
+  struct LineSink {
+    const Sink& sink;
+    TraceId trace;
+
+    void operator()(const OverlayCommand& command) const {
+      if (trace) LatencyTracer::get().mark(trace, TraceStage::PARSED);
+      sink(command, trace);
+    }
+  };
+
+  // Handlers consume the arguments after the command name and return
+  // false if the line is malformed.
+  using Handler = bool (CommandParser::*)(
+      CommandOp op,
+      std::string_view args,
+      const LineSink& sink) const;
+
+  struct Verb {
+    Handler handler = nullptr;
+    CommandOp op = CommandOp::NONE;
+  };
+
+  static const Verb* findVerb(std::string_view name);
+
+  bool parseLine(std::string_view line, const LineSink& sink) const;
+  bool parseScroll(
+      CommandOp op,
+      std::string_view args,
+      const LineSink& sink) const;
+  bool parseVolume(
+      CommandOp op,
+      std::string_view args,
+      const LineSink& sink) const;
+  bool parsePrimitive(
+      CommandOp op,
+      std::string_view args,
+      const LineSink& sink) const;
+  void parseFields(
+      int32_t id,
+      std::string_view args,
+      const LineSink& sink) const;
+  void log(const std::string& msg) const;
+
+  Hooks m_hooks;
+  mutable std::atomic<uint64_t> m_rejected{0};
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * Overlay command opcodes.
+ * Values are part of the binary ring protocol; only append.
+ */
+enum class CommandOp : uint16_t {
+  NONE = 0,
+  VOLUME_UP = 1,
+  VOLUME_DOWN = 2,
+  VOLUME_LEVEL = 3,
+  SCROLL_START = 4,
+  SCROLL_STOP = 5,
+  MUTE_CLEAR = 6,
+  MUTE_ADD = 7,
+  MUTE_REMOVE = 8,
+  REPAINT = 9,       // Internal: icons finished decoding
+  RELOAD_ICONS = 10, // Internal: icon files changed on disk
+  PRIM_CREATE = 11,  // level = id, flags = PrimitiveKind
+  PRIM_SET = 12,     // level = id, flags = PrimitiveField, x = value
+  PRIM_DESTROY = 13, // level = id
+};
+
+constexpr size_t COMMAND_OP_COUNT = (size_t)CommandOp::PRIM_DESTROY + 1;
+
+/**
+ * Returns whether clients may send op. Mute ops come from the mute
+ * state file only, and REPAINT and RELOAD_ICONS are posted by the
+ * plugin itself.
+ */
+constexpr bool isClientOp(CommandOp op) {
+  switch (op) {
+    case CommandOp::VOLUME_UP:
+    case CommandOp::VOLUME_DOWN:
+    case CommandOp::VOLUME_LEVEL:
+    case CommandOp::SCROLL_START:
+    case CommandOp::SCROLL_STOP:
+    case CommandOp::PRIM_CREATE:
+    case CommandOp::PRIM_SET:
+    case CommandOp::PRIM_DESTROY:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * Parsed overlay command.
+ * Doubles as the fixed-layout record written by ring producers,
+ * so the text and binary paths share one representation.
+ */
+struct OverlayCommand {
+  CommandOp op = CommandOp::NONE;
+  uint16_t flags = 0;
+  int32_t level = 0;    // Volume percentage 0-100, or primitive id
+  uint64_t window = 0;  // Window address as printed by hyprctl
+  double x = 0;         // Global coordinates for scroll anchors
+  double y = 0;
+};
+
+static_assert(sizeof(OverlayCommand) == 32);
+static_assert(std::is_trivially_copyable_v<OverlayCommand>);
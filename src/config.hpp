@@ -1,59 +1,146 @@
 #pragma once
 
 #include <string>
+#include <array>
+#include <cstdlib>
 #include "types.hpp"
 
 /**
  * Default configuration values.
+ * Everything a user can change lives in settings.hpp, which starts
+ * from these and is refreshed from the Hyprland config.
  */
 namespace config {
 
 // Timing
 constexpr int DEFAULT_DISPLAY_MS = 800;
 constexpr int DEFAULT_FADE_MS = 100;
-constexpr int DEFAULT_POLL_INTERVAL_MS = 10;
 
 // Sizing
-constexpr int DEFAULT_ICON_SIZE = 128;
+constexpr int DEFAULT_ICON_SIZE = 0;  // 0 draws icons at native size
 constexpr int DEFAULT_PADDING = 10;
 constexpr int MAX_STACKED_EVENTS = 3;
+constexpr double TETHER_DAMAGE_CHUNK = 64.0;  // Tether damage box length
+
+// Icon atlas
+constexpr bool USE_ICON_ATLAS = true;
+constexpr int ATLAS_PAGE_SIZE = 1024;
+constexpr int ATLAS_PADDING = 1;
+
+// Background PNG decoding
+constexpr size_t DECODE_THREADS = 2;
+
+// Client-created primitives
+constexpr size_t MAX_PRIMITIVES = 1024;
+
+// Icons registered by name through primitives
+constexpr size_t MAX_DYNAMIC_ICONS = 256;
+
+// Texture memory
+constexpr int DEFAULT_TEXTURE_BUDGET_KB = 16 * 1024;
+constexpr size_t MAX_ICON_VARIANTS = 64;  // Prescaled copies, all sizes
+constexpr int MAX_VARIANT_BUILDS_PER_FRAME = 2;
+constexpr uint64_t VARIANT_IDLE_FRAMES = 600;  // Unused copies then dropped
+
+// Text rendering
+constexpr const char* DEFAULT_FONT = "Sans";
+constexpr int DEFAULT_FONT_SIZE = 14;
+constexpr size_t TEXT_LABEL_CACHE = 64;   // Whole-label textures
+constexpr size_t TEXT_GLYPH_SETS = 8;     // Digit atlases, per font size
 
 // IPC file paths
 inline const std::string MUTE_STATE_FILE = "/tmp/volume-mute-state";
 inline const std::string OVERLAY_CMD_FILE = "/tmp/superglue-overlay-cmd";
 inline const std::string LOG_FILE = "/tmp/superglue.log";
 
+// Logging
+constexpr size_t LOG_QUEUE_CAPACITY = 1024;         // Messages in flight
+constexpr size_t LOG_MESSAGE_BYTES = 240;           // Longer ones are cut
+constexpr size_t LOG_MAX_FILE_BYTES = 1024 * 1024;  // Then rotated to .1
+constexpr uint32_t LOG_RATE_PER_SECOND = 20;        // Per call site
+constexpr int LOG_FLUSH_MS = 100;                   // Batching delay
+
+// IPC socket
+inline const std::string SOCKET_NAME = "superglue.sock";
+constexpr size_t IPC_MAX_LINE_BYTES = 64 * 1024;
+constexpr size_t IPC_MAX_READ_BYTES = 256 * 1024;  // Per client wakeup
+constexpr size_t COMMAND_QUEUE_CAPACITY = 4096;
+
+// Latency tracing
+constexpr size_t TRACE_CAPACITY = 1024;  // Most recent traced commands
+
 /**
- * Returns the default icon path for an overlay type.
+ * Returns the command socket path, preferring $XDG_RUNTIME_DIR.
  */
-inline std::string getDefaultIconPath(OverlayType type) {
-  std::string home = getenv("HOME");
+inline std::string getSocketPath() {
+  const char* runtimeDir = getenv("XDG_RUNTIME_DIR");
+  std::string dir = runtimeDir && *runtimeDir ? runtimeDir : "/tmp";
+  return dir + "/" + SOCKET_NAME;
+}
+
+constexpr int VOLUME_LEVEL_ICONS = 14;
+
+/**
+ * Returns the default directory icons are loaded from.
+ */
+inline const std::string& getIconDir() {
+  static const std::string dir = [] {
+    const char* home = getenv("HOME");
+    return std::string(home ? home : "") + "/.icons";
+  }();
+  return dir;
+}
+
+/**
+ * Returns the default icon file base name for an overlay type.
+ * The anchor adds _up/_down variants; volume levels append 0..13.
+ */
+inline const char* getDefaultIconName(OverlayType type) {
   switch (type) {
     case OverlayType::VOLUME_UP:
-      return home + "/.icons/up.png";
+      return "up";
     case OverlayType::VOLUME_DOWN:
-      return home + "/.icons/down.png";
+      return "down";
     case OverlayType::MUTE:
-      return home + "/.icons/mute.png";
+      return "mute";
     case OverlayType::SCROLL_ANCHOR:
-      return home + "/.icons/anchor.png";
+      return "anchor";
+    case OverlayType::VOLUME_LEVEL:
+      return "volume_";
     default:
       return "";
   }
 }
 
 /**
- * Returns the volume level icon path based on percentage.
+ * Returns the default icon for an overlay type.
+ */
+inline IconId getDefaultIcon(OverlayType type) {
+  switch (type) {
+    case OverlayType::VOLUME_UP:
+      return IconId::VOLUME_UP;
+    case OverlayType::VOLUME_DOWN:
+      return IconId::VOLUME_DOWN;
+    case OverlayType::MUTE:
+      return IconId::MUTE;
+    case OverlayType::SCROLL_ANCHOR:
+      return IconId::ANCHOR;
+    default:
+      return IconId::NONE;
+  }
+}
+
+/**
+ * Returns the volume level icon based on percentage.
  * Maps 0-100% to volume_0.png through volume_13.png.
  */
-inline std::string getVolumeLevelIconPath(int volumePercent) {
-  std::string home = getenv("HOME");
+inline IconId getVolumeLevelIcon(int volumePercent) {
   // Clamp to 0-100
   if (volumePercent < 0) volumePercent = 0;
   if (volumePercent > 100) volumePercent = 100;
   // Map 0-100 to 0-13 (14 icons total)
-  int iconIndex = (volumePercent * 13) / 100;
-  return home + "/.icons/volume_" + std::to_string(iconIndex) + ".png";
+  int iconIndex = (volumePercent * (VOLUME_LEVEL_ICONS - 1)) / 100;
+  return (IconId)((int)IconId::VOLUME_0 + iconIndex);
 }
 
 /**
@@ -61,7 +148,7 @@ inline std::string getVolumeLevelIconPath(int volumePercent) {
  */
 inline OverlayConfig getDefaultConfig(OverlayType type) {
   OverlayConfig cfg;
-  cfg.iconPath = getDefaultIconPath(type);
+  cfg.icon = getDefaultIcon(type);
   cfg.position = Position::CENTER;
   cfg.displayMs = DEFAULT_DISPLAY_MS;
   cfg.fadeMs = DEFAULT_FADE_MS;
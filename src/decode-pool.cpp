@@ -0,0 +1,40 @@
+#include "decode-pool.hpp"
+
+DecodePool::DecodePool(size_t threads) {
+  for (size_t i = 0; i < threads; ++i) {
+    m_threads.emplace_back(&DecodePool::workerLoop, this);
+  }
+}
+
+DecodePool::~DecodePool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_cv.notify_all();
+  for (auto& thread : m_threads) {
+    if (thread.joinable()) thread.join();
+  }
+}
+
+void DecodePool::submit(Job job) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_jobs.push_back(std::move(job));
+  }
+  m_cv.notify_one();
+}
+
+void DecodePool::workerLoop() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+      if (m_stopping) return;
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+    job();
+  }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Small fixed-size worker pool for image decoding.
+ * Jobs run in FIFO order on background threads; they must not
+ * touch GL, which is only available on the render thread.
+ */
+class DecodePool {
+ public:
+  using Job = std::function<void()>;
+
+  explicit DecodePool(size_t threads);
+  ~DecodePool();
+
+  /**
+   * Queues a job for the next idle worker.
+   */
+  void submit(Job job);
+
+ private:
+  void workerLoop();
+
+  std::vector<std::thread> m_threads;
+  std::deque<Job> m_jobs;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_stopping = false;
+};
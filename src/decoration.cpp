@@ -2,6 +2,12 @@
 #include "overlay-state.hpp"
 #include "texture-cache.hpp"
 #include "pass-element.hpp"
+#include "icon-batch.hpp"
+#include "tether-renderer.hpp"
+#include "text-cache.hpp"
+#include "shape-batch.hpp"
+#include "settings.hpp"
+#include "metrics.hpp"
 #include <hyprland/src/Compositor.hpp>
 #include <hyprland/src/render/Renderer.hpp>
 #include <hyprland/src/managers/input/InputManager.hpp>
@@ -9,7 +15,7 @@
 Superglue::Superglue(PHLWINDOW pWindow)
     : IHyprWindowDecoration(pWindow) {
   m_pWindowRef = pWindow;
-  m_windowAddress = std::format("0x{:x}", (uintptr_t)pWindow.get());
+  m_windowHandle = (WindowHandle)pWindow.get();
 
   if (OverlayState::get()) {
     OverlayState::get()->registerWindow(this);
@@ -54,49 +60,251 @@ void Superglue::updateWindow(PHLWINDOW pWindow) {
   damageEntire();
 }
 
+// Tether look, shared by drawing and damage tracking.
+static constexpr float TETHER_DOT_SPACING = 15.0f;
+
+static float tetherThickness(float len) {
+  // Dynamic Thickness: Standard 4.0, reduces slowly.
+  // Formula: 4.0 - (len / 300.0). reaching min size at ~600px.
+  float dotSize = 4.0f - (len / 300.0f);
+  if (dotSize < 2.0f) dotSize = 2.0f; // Minimum thickness (more firm)
+  return dotSize;
+}
+
+// Fits an icon into the configured size, keeping its aspect ratio.
+static Vector2D scaledIconSize(
+    const OverlayConfig& cfg,
+    const Vector2D& nativeSize) {
+  double longest = std::max(nativeSize.x, nativeSize.y);
+  if (cfg.iconSize <= 0 || longest <= 0) return nativeSize;
+  return nativeSize * (cfg.iconSize / longest);
+}
+
+// Covers a segment with short boxes rather than one bounding box, so
+// a diagonal line does not damage the whole rectangle it spans.
+static void addSegmentRegion(
+    const Vector2D& start,
+    const Vector2D& end,
+    double margin,
+    CRegion& region) {
+  Vector2D diff = end - start;
+  double len = std::sqrt(diff.x * diff.x + diff.y * diff.y);
+  int chunks = std::max(1, (int)std::ceil(len / config::TETHER_DAMAGE_CHUNK));
+  for (int i = 0; i < chunks; ++i) {
+    Vector2D from = start + diff * ((double)i / chunks);
+    Vector2D to = start + diff * ((double)(i + 1) / chunks);
+    region.add(CBox{
+        std::min(from.x, to.x) - margin,
+        std::min(from.y, to.y) - margin,
+        std::abs(to.x - from.x) + 2 * margin,
+        std::abs(to.y - from.y) + 2 * margin});
+  }
+}
+
+// Primitive colour with its alpha and the window's fade applied.
+static CHyprColor primitiveColor(
+    const Primitive& primitive,
+    float alpha,
+    uint32_t rgba) {
+  CHyprColor color;
+  color.r = ((rgba >> 24) & 0xff) / 255.0f;
+  color.g = ((rgba >> 16) & 0xff) / 255.0f;
+  color.b = ((rgba >> 8) & 0xff) / 255.0f;
+  color.a = (rgba & 0xff) / 255.0f * primitive.alpha * alpha;
+  return color;
+}
+
+static CHyprColor primitiveColor(const Primitive& primitive, float alpha) {
+  return primitiveColor(primitive, alpha, primitive.color);
+}
+
+static CBox primitiveIconBox(
+    const Primitive& primitive,
+    const CBox& windowBox,
+    const Vector2D& nativeSize) {
+  Vector2D size = primitive.w > 0 && primitive.h > 0
+      ? Vector2D{primitive.w, primitive.h}
+      : nativeSize;
+  return {windowBox.x + primitive.x, windowBox.y + primitive.y,
+          size.x, size.y};
+}
+
+static int textSize(const Primitive& primitive) {
+  return primitive.size > 0 ? (int)std::round(primitive.size)
+                            : settings::fontSize();
+}
+
+// Text is rasterized at its pixel size so it stays crisp; hinting
+// makes that box differ from the layout-size box times scale.
+static int textPixels(const Primitive& primitive, double scale) {
+  return (int)std::round(textSize(primitive) * scale);
+}
+
+// A window is drawn only on the monitor holding its centre.
+static bool drawsOn(const CBox& windowBox, const PHLMONITOR& monitor) {
+  Vector2D center = {windowBox.x + windowBox.w / 2,
+                     windowBox.y + windowBox.h / 2};
+  return center.x >= monitor->m_position.x &&
+      center.x <= monitor->m_position.x + monitor->m_size.x &&
+      center.y >= monitor->m_position.y &&
+      center.y <= monitor->m_position.y + monitor->m_size.y;
+}
+
+// Scale of the monitor a window is drawn on, for sizing damage.
+static double drawScale(const CBox& windowBox) {
+  if (!g_pCompositor) return 1.0;
+  for (const auto& monitor : g_pCompositor->m_monitors) {
+    if (monitor && drawsOn(windowBox, monitor)) return monitor->m_scale;
+  }
+  return 1.0;
+}
+
+// Queues an icon drawn into box (monitor pixels), from a copy
+// prescaled to the box once the cache has built one.
+static void drawIcon(
+    IconId icon,
+    const TextureRegion& region,
+    const CBox& box,
+    float alpha) {
+  const TextureRegion* scaled =
+      TextureCache::get().variant(icon, {box.w, box.h});
+  IconBatch::get().add(scaled ? *scaled : region, box, alpha);
+}
+
+static IconId anchorIcon(const Vector2D& diff, float len) {
+  if (len <= 10.0f) return IconId::ANCHOR;
+  return diff.y > 0 ? IconId::ANCHOR_DOWN : IconId::ANCHOR_UP;
+}
+
 void Superglue::damageEntire() {
-  CBox box = getVisualBox();
-  g_pHyprRenderer->damageBox(box);
+  // Called between frames (state changes, window updates): size the
+  // damage from a snapshot of its own at the model clock's now, and
+  // leave the frame's snapshot to draw().
+  OverlaySnapshot snapshot;
+  if (auto* state = OverlayState::get()) {
+    state->buildSnapshot(m_windowHandle, state->now(), snapshot);
+  }
+  damageVisual(snapshot);
 }
 
-CBox Superglue::getVisualBox() {
-  CBox box = assignedBoxGlobal();
-  
-  // Extend for scroll anchor tether
+void Superglue::damageVisual(const OverlaySnapshot& snapshot) {
+  CRegion current = computeVisualRegion(snapshot);
+  CRegion damage = current;
+  damage.add(m_lastDamage);
+  if (!damage.empty()) {
+    g_pHyprRenderer->damageRegion(damage);
+
+    uint64_t pixels = 0;
+    for (const auto& rect : damage.getRects()) {
+      pixels += (uint64_t)(rect.x2 - rect.x1) * (rect.y2 - rect.y1);
+    }
+    Metrics::get().record(Histogram::DAMAGE_PIXELS, pixels);
+  }
+  m_lastDamage = current;
+}
+
+void Superglue::refreshSnapshot(
+    std::chrono::steady_clock::time_point now) {
   if (OverlayState::get()) {
-    auto states = OverlayState::get()->getOverlayInfo(m_windowAddress);
-    for (const auto& info : states) {
-      if (info.type == OverlayType::SCROLL_ANCHOR) {
-         // Current bounds
-         double minX = box.x;
-         double minY = box.y;
-         double maxX = box.x + box.w;
-         double maxY = box.y + box.h;
-
-         // Check Anchor
-         minX = std::min(minX, (double)info.x);
-         minY = std::min(minY, (double)info.y);
-         maxX = std::max(maxX, (double)info.x);
-         maxY = std::max(maxY, (double)info.y);
-
-         // Check Mouse
-         Vector2D mousePos = g_pInputManager->getMouseCoordsInternal();
-         minX = std::min(minX, (double)mousePos.x);
-         minY = std::min(minY, (double)mousePos.y);
-         maxX = std::max(maxX, (double)mousePos.x);
-         maxY = std::max(maxY, (double)mousePos.y);
-
-         // Padding (50px)
-         minX -= 50.0;
-         minY -= 50.0;
-         maxX += 50.0;
-         maxY += 50.0;
-
-         box = {minX, minY, maxX - minX, maxY - minY};
+    OverlayState::get()->buildSnapshot(m_windowHandle, now, m_snapshot);
+  } else {
+    m_snapshot.clear();
+  }
+}
+
+CRegion Superglue::computeVisualRegion(const OverlaySnapshot& snapshot) {
+  CRegion region;
+  CBox windowBox = assignedBoxGlobal();
+
+  for (const auto& info : snapshot) {
+    if (info.type == OverlayType::SCROLL_ANCHOR) {
+      addTetherRegion(info, region);
+    } else if (auto* texture = TextureCache::get().peek(info.icon)) {
+      region.add(getIconBox(info, windowBox, texture->size));
+    }
+  }
+
+  if (auto* state = OverlayState::get()) {
+    double scale = drawScale(windowBox);
+    state->forEachPrimitive(
+        m_windowHandle, snapshot.time, [&](const Primitive& primitive) {
+          addPrimitiveRegion(primitive, windowBox, scale, region);
+        });
+  }
+  return region;
+}
+
+void Superglue::addPrimitiveRegion(
+    const Primitive& primitive,
+    const CBox& windowBox,
+    double scale,
+    CRegion& region) {
+  Vector2D origin = {windowBox.x, windowBox.y};
+  switch (primitive.kind) {
+    case PrimitiveKind::RECT:
+    case PrimitiveKind::PROGRESS:
+      // One extra pixel for the antialiased edge.
+      region.add(CBox{origin.x + primitive.x - 1, origin.y + primitive.y - 1,
+                      primitive.w + 2, primitive.h + 2});
+      break;
+    case PrimitiveKind::CIRCLE: {
+      double extent = primitive.radius + 1;
+      region.add(CBox{origin.x + primitive.x - extent,
+                      origin.y + primitive.y - extent,
+                      2 * extent, 2 * extent});
+      break;
+    }
+    case PrimitiveKind::LINE:
+      addSegmentRegion(
+          origin + Vector2D{primitive.x, primitive.y},
+          origin + Vector2D{primitive.x2, primitive.y2},
+          primitive.thickness / 2.0 + 2.0, region);
+      break;
+    case PrimitiveKind::ICON:
+      if (auto* texture = TextureCache::get().peek(primitive.icon)) {
+        region.add(primitiveIconBox(primitive, windowBox, texture->size));
       }
+      break;
+    case PrimitiveKind::TEXT: {
+      // Measured as drawn, at the pixel size, then back to layout.
+      Vector2D size = TextCache::get().measure(
+          primitive.text, settings::font(),
+          textPixels(primitive, scale)) / scale;
+      // Drawing snaps to whole pixels; allow for the rounding.
+      region.add(CBox{origin.x + primitive.x - 1, origin.y + primitive.y - 1,
+                      size.x + 2, size.y + 2});
+      break;
     }
   }
-  return box;
+}
+
+bool Superglue::hasContent() {
+  return !m_snapshot.empty() ||
+      (OverlayState::get() &&
+       OverlayState::get()->hasPrimitives(m_windowHandle));
+}
+
+void Superglue::addTetherRegion(const OverlayInfo& info, CRegion& region) {
+  Vector2D anchorPos = {info.x, info.y};
+  Vector2D mousePos = g_pInputManager->getMouseCoordsInternal();
+  Vector2D diff = mousePos - anchorPos;
+  float len = std::sqrt(diff.x * diff.x + diff.y * diff.y);
+
+  addSegmentRegion(anchorPos, mousePos, tetherThickness(len) + 2.0, region);
+
+  if (auto* texture = TextureCache::get().peek(anchorIcon(diff, len))) {
+    Vector2D iconSize = scaledIconSize(
+        settings::forType(OverlayType::SCROLL_ANCHOR), texture->size);
+    region.add(CBox{
+        anchorPos.x - iconSize.x / 2.0,
+        anchorPos.y - iconSize.y / 2.0,
+        iconSize.x,
+        iconSize.y});
+  }
+}
+
+CBox Superglue::getVisualBox() {
+  return computeVisualRegion(m_snapshot).getExtents();
 }
 
 CBox Superglue::assignedBoxGlobal() {
@@ -118,29 +326,20 @@ void Superglue::draw(PHLMONITOR pMonitor, float const& a) {
   }
 
   // Only draw on monitors where the window is actually visible
-  // Check if window intersects with this monitor's area
-  CBox windowBox = assignedBoxGlobal();
-  Vector2D windowCenter = {
-    windowBox.x + windowBox.w / 2,
-    windowBox.y + windowBox.h / 2
-  };
-
-  // Simple check: is window center within monitor bounds?
-  if (windowCenter.x < pMonitor->m_position.x ||
-      windowCenter.x > pMonitor->m_position.x + pMonitor->m_size.x ||
-      windowCenter.y < pMonitor->m_position.y ||
-      windowCenter.y > pMonitor->m_position.y + pMonitor->m_size.y) {
-    return;
-  }
+  if (!drawsOn(assignedBoxGlobal(), pMonitor)) return;
 
   if (!OverlayState::get()) return;
 
-  auto states = OverlayState::get()->getOverlayInfo(m_windowAddress);
-  if (states.empty()) return;
+  // One snapshot per frame, reused by renderPass and getVisualBox.
+  refreshSnapshot(OverlayState::get()->frameTime());
+  // A trace whose command cleared the window ends here, unrendered.
+  TraceId trace = OverlayState::get()->takeTrace(m_windowHandle);
+  if (!hasContent()) return;
 
   GluePassElement::SGlueData data;
   data.deco = this;
   data.a = a;
+  data.trace = trace;
   g_pHyprRenderer->m_renderPass.add(makeUnique<GluePassElement>(data));
 }
 
@@ -150,13 +349,18 @@ void Superglue::renderPass(PHLMONITOR pMonitor, float a) {
     return;
   }
 
-  if (!OverlayState::get()) return;
+  const auto& states = m_snapshot;
+  if (!hasContent()) return;
 
-  auto states = OverlayState::get()->getOverlayInfo(m_windowAddress);
-  if (states.empty()) return;
+  auto start = std::chrono::steady_clock::now();
+  uint32_t drawn = 0;
+
+  // Icons decoded in the background since the last frame become
+  // drawable here, where the GL context is current.
+  TextureCache::get().uploadPending();
 
   CBox windowBox = assignedBoxGlobal();
-  bool hasAnchor = false;
+  Viewport view = {pMonitor->m_position, pMonitor->m_scale};
 
   // Render volume overlays first (bottom layer)
   for (const auto& info : states) {
@@ -164,64 +368,53 @@ void Superglue::renderPass(PHLMONITOR pMonitor, float a) {
     if (type == OverlayType::MUTE || type == OverlayType::SCROLL_ANCHOR) {
       continue;
     }
-    renderOverlay(info, windowBox, a, pMonitor->m_position);
+    drawn += renderOverlay(info, windowBox, a, view);
   }
 
   // Render mute overlay (top layer)
   for (const auto& info : states) {
     if (info.type == OverlayType::MUTE) {
-      renderOverlay(info, windowBox, a, pMonitor->m_position);
+      drawn += renderOverlay(info, windowBox, a, view);
     }
   }
 
+  // Icons above were only queued; draw them in one batch.
+  IconBatch::get().flush();
+
+  drawn += renderPrimitives(windowBox, a, view);
+
   // Render Scroll Anchor + Line
   for (const auto& info : states) {
     if (info.type == OverlayType::SCROLL_ANCHOR) {
-      renderAnchorLine(info, windowBox, a, pMonitor->m_position);
-      hasAnchor = true;
+      renderAnchorLine(info, windowBox, a, view);
+      ++drawn;
     }
   }
 
-  // Continuous update if anchor is active
-  if (hasAnchor) {
-    damageEntire();
-  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  Metrics::get().recordRenderPass(
+      m_windowHandle, (uint64_t)pMonitor.get(), pMonitor->m_name,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+      drawn);
 }
 
 void Superglue::renderAnchorLine(
     const OverlayInfo& info, 
     const CBox& windowBox, 
     float alpha,
-    const Vector2D& monitorPos) {
+    const Viewport& view) {
   // 1. Calculate geometry
   Vector2D anchorPos = {info.x, info.y}; // Anchor center
   Vector2D mousePos = g_pInputManager->getMouseCoordsInternal();
 
   Vector2D diff = mousePos - anchorPos;
   float len = std::sqrt(diff.x * diff.x + diff.y * diff.y);
-  
-  // Normalized direction
-  Vector2D dir = {0, 0};
-  if (len > 0.1f) {
-    dir = diff / len;
-  }
 
   // 2. Determine Anchor Icon based on direction
-  std::string iconName = "anchor.png";
-  if (len > 10.0f) {
-      if (diff.y > 0) iconName = "anchor_down.png";
-      else iconName = "anchor_up.png";
-  }
-  std::string iconPath = std::string(getenv("HOME")) + "/.icons/" + iconName;
+  IconId icon = anchorIcon(diff, len);
 
   // 3. Render Dotted Line (Red) - UNDER Anchor
-  // Draw dots every 15 pixels
-  float step = 15.0f;
-  
-  // Dynamic Thickness: Standard 4.0, reduces slowly.
-  // Formula: 4.0 - (len / 300.0). reaching min size at ~600px.
-  float dotSize = 4.0f - (len / 300.0f);
-  if (dotSize < 2.0f) dotSize = 2.0f; // Minimum thickness (more firm)
+  float dotSize = tetherThickness(len);
 
   CHyprColor dotColor;
   dotColor.r = 1.0f;
@@ -229,56 +422,118 @@ void Superglue::renderAnchorLine(
   dotColor.b = 0.0f;
   dotColor.a = alpha * 0.8f;
 
-  for (float d = step; d < len; d += step) {
-    Vector2D dotPos = anchorPos + (dir * d);
-    
-    // Translate to Monitor-Local coordinates
-    Vector2D localDotPos = dotPos - monitorPos;
-    
-    // Center dot
-    CBox dotBox = {
-        localDotPos.x - dotSize/2.0,
-        localDotPos.y - dotSize/2.0,
-        (double)dotSize,
-        (double)dotSize
-    };
-
-    CHyprOpenGLImpl::SRectRenderData rectData;
-    rectData.round = 1;
-    
-    g_pHyprOpenGL->renderRect(dotBox, dotColor, rectData);
-  }
+  // Translate to monitor pixels; the shader places the dots.
+  int dots = TetherRenderer::get().draw(
+      view.toPixels(anchorPos), view.toPixels(mousePos),
+      dotSize * view.scale, TETHER_DOT_SPACING * view.scale, dotColor);
+  Metrics::get().add(Counter::TETHER_DOTS, dots);
 
   // 4. Render Anchor Icon - ON TOP
-  auto& cache = TextureCache::get();
-  auto tex = cache.load(iconPath);
-  if (tex) {
-      Vector2D iconSize = cache.getSize(iconPath);
-      // Translate to Monitor-Local
-      CBox iconBox = {
-          anchorPos.x - monitorPos.x - (iconSize.x / 2.0f),
-          anchorPos.y - monitorPos.y - (iconSize.y / 2.0f),
+  if (auto* region = TextureCache::get().region(icon)) {
+      Vector2D iconSize = scaledIconSize(
+          settings::forType(OverlayType::SCROLL_ANCHOR), region->size);
+      // Translate to monitor pixels
+      CBox iconBox = view.toPixels(CBox{
+          anchorPos.x - (iconSize.x / 2.0f),
+          anchorPos.y - (iconSize.y / 2.0f),
           iconSize.x,
           iconSize.y
-      };
-      CHyprOpenGLImpl::STextureRenderData texData;
-      texData.a = alpha;
-      g_pHyprOpenGL->renderTexture(tex, iconBox, texData);
+      });
+      drawIcon(icon, *region, iconBox, alpha);
+      IconBatch::get().flush();
   }
 }
 
-void Superglue::renderOverlay(
+uint32_t Superglue::renderPrimitives(
+    const CBox& windowBox,
+    float alpha,
+    const Viewport& view) {
+  auto* state = OverlayState::get();
+  if (!state) return 0;
+
+  // Primitive geometry is in layout units relative to the window;
+  // every length is scaled along with the positions.
+  Vector2D origin = {windowBox.x, windowBox.y};
+  double scale = view.scale;
+  auto pointOf = [&](double x, double y) {
+    return view.toPixels(origin + Vector2D{x, y});
+  };
+  auto boxOf = [&](const Primitive& primitive) {
+    return view.toPixels(CBox{origin.x + primitive.x, origin.y + primitive.y,
+                              primitive.w, primitive.h});
+  };
+
+  auto& shapes = ShapeBatch::get();
+  uint32_t drawn = 0;
+  state->forEachPrimitive(
+      m_windowHandle, m_snapshot.time, [&](const Primitive& primitive) {
+        ++drawn;
+        switch (primitive.kind) {
+          case PrimitiveKind::RECT:
+            shapes.addRect(
+                boxOf(primitive), primitiveColor(primitive, alpha),
+                primitive.radius * scale, primitive.ring * scale);
+            break;
+          case PrimitiveKind::PROGRESS:
+            shapes.addProgress(
+                boxOf(primitive), primitive.value,
+                primitiveColor(primitive, alpha),
+                primitiveColor(primitive, alpha, primitive.background),
+                primitive.radius * scale);
+            break;
+          case PrimitiveKind::CIRCLE:
+            shapes.addCircle(
+                pointOf(primitive.x, primitive.y), primitive.radius * scale,
+                primitiveColor(primitive, alpha), primitive.ring * scale);
+            break;
+          case PrimitiveKind::LINE:
+            shapes.addLine(
+                pointOf(primitive.x, primitive.y),
+                pointOf(primitive.x2, primitive.y2),
+                primitive.thickness * scale, primitiveColor(primitive, alpha));
+            break;
+          case PrimitiveKind::ICON:
+            if (auto* region = TextureCache::get().region(primitive.icon)) {
+              CBox box = view.toPixels(
+                  primitiveIconBox(primitive, windowBox, region->size));
+              drawIcon(primitive.icon, *region, box, alpha * primitive.alpha);
+            }
+            break;
+          case PrimitiveKind::TEXT:
+            TextCache::get().draw(
+                primitive.text, settings::font(),
+                textPixels(primitive, scale),
+                pointOf(primitive.x, primitive.y),
+                primitiveColor(primitive, alpha));
+            break;
+        }
+      });
+
+  // Shapes go down first, in one draw; icons and text land on top.
+  shapes.flush();
+  IconBatch::get().flush();
+  return drawn;
+}
+
+bool Superglue::renderOverlay(
     const OverlayInfo& info,
     const CBox& windowBox,
     float alpha,
-    const Vector2D& monitorPos) {
-  if (info.iconPath.empty()) return;
+    const Viewport& view) {
+  auto* region = TextureCache::get().region(info.icon);
+  if (!region) return false;
 
-  auto& cache = TextureCache::get();
-  auto tex = cache.load(info.iconPath);
-  if (!tex) return;
+  CBox iconBox = view.toPixels(getIconBox(info, windowBox, region->size));
+  drawIcon(info.icon, *region, iconBox, alpha * info.opacity);
+  return true;
+}
 
-  Vector2D iconSize = cache.getSize(info.iconPath);
+CBox Superglue::getIconBox(
+    const OverlayInfo& info,
+    const CBox& windowBox,
+    const Vector2D& nativeSize) {
+  const OverlayConfig& cfg = settings::forType(info.type);
+  Vector2D iconSize = scaledIconSize(cfg, nativeSize);
   Vector2D pos;
 
   if (info.hasCustomPos) {
@@ -288,29 +543,20 @@ void Superglue::renderOverlay(
     pos.y = info.y - (iconSize.y / 2.0f);
   } else {
     // Standard position logic
-    // Retrieves default config for type (could be optimized)
-    auto cfg = config::getDefaultConfig(info.type);
-    pos = calculateIconPosition(windowBox, iconSize, cfg.position);
+    pos = calculateIconPosition(
+        windowBox, iconSize, cfg.position, cfg.padding);
   }
 
-  CBox iconBox = {
-      pos.x - monitorPos.x,
-      pos.y - monitorPos.y,
-      iconSize.x,
-      iconSize.y
-  };
-
-  CHyprOpenGLImpl::STextureRenderData texData;
-  texData.a = alpha * info.opacity;
-  g_pHyprOpenGL->renderTexture(tex, iconBox, texData);
+  return {pos.x, pos.y, iconSize.x, iconSize.y};
 }
 
 Vector2D Superglue::calculateIconPosition(
     const CBox& windowBox,
     const Vector2D& iconSize,
-    Position position) {
+    Position position,
+    int padding) {
   float x = 0, y = 0;
-  float pad = config::DEFAULT_PADDING;
+  float pad = padding;
 
   switch (position) {
     case Position::TOP_LEFT:
@@ -5,7 +5,26 @@
 #include <hyprland/src/render/OpenGL.hpp>
 #include "types.hpp"
 #include "config.hpp"
-#include <vector>
+#include "primitive.hpp"
+#include <chrono>
+
+/**
+ * Maps global layout coordinates to the pixels of the monitor being
+ * rendered, which is what the draw paths take.
+ */
+struct Viewport {
+  Vector2D origin;  // Monitor position in the layout
+  double scale = 1.0;
+
+  Vector2D toPixels(const Vector2D& global) const {
+    return (global - origin) * scale;
+  }
+
+  CBox toPixels(const CBox& global) const {
+    return {(global.x - origin.x) * scale, (global.y - origin.y) * scale,
+            global.w * scale, global.h * scale};
+  }
+};
 
 /**
  * Window decoration that displays overlay icons.
@@ -29,28 +48,66 @@ class Superglue : public IHyprWindowDecoration {
 
   void renderPass(PHLMONITOR pMonitor, float a);
   CBox assignedBoxGlobal();
-  std::string getWindowAddress() { return m_windowAddress; }
+  WindowHandle getWindowHandle() { return m_windowHandle; }
   CBox getVisualBox();
 
  private:
+  void refreshSnapshot(std::chrono::steady_clock::time_point now);
+
+  /**
+   * Damages what snapshot draws plus what was damaged for the
+   * previous one, so stale pixels get cleared.
+   */
+  void damageVisual(const OverlaySnapshot& snapshot);
+
+  /**
+   * Exact global-space area snapshot draws into.
+   */
+  CRegion computeVisualRegion(const OverlaySnapshot& snapshot);
+  void addTetherRegion(const OverlayInfo& info, CRegion& region);
+  void addPrimitiveRegion(
+      const Primitive& primitive,
+      const CBox& windowBox,
+      double scale,
+      CRegion& region);
+  bool hasContent();
+
+  CBox getIconBox(
+      const OverlayInfo& info,
+      const CBox& windowBox,
+      const Vector2D& nativeSize);
+
   Vector2D calculateIconPosition(
       const CBox& windowBox,
       const Vector2D& iconSize,
-      Position position);
+      Position position,
+      int padding);
 
-  void renderOverlay(
+  bool renderOverlay(
       const OverlayInfo& info,
       const CBox& windowBox,
       float alpha,
-      const Vector2D& monitorPos);
+      const Viewport& view);
+
+  /**
+   * Draws client-created primitives. Vector shapes are batched into
+   * one SDF draw in creation order; icons and text land above them.
+   * Returns how many primitives were drawn.
+   */
+  uint32_t renderPrimitives(
+      const CBox& windowBox,
+      float alpha,
+      const Viewport& view);
 
   void renderAnchorLine(
       const OverlayInfo& info,
       const CBox& windowBox,
       float alpha,
-      const Vector2D& monitorPos);
+      const Viewport& view);
 
   PHLWINDOWREF m_pWindowRef;
-  std::string m_windowAddress;
+  WindowHandle m_windowHandle = 0;
   CBox m_bAssignedBox;
+  OverlaySnapshot m_snapshot;
+  CRegion m_lastDamage;  // Visual region of the last damaged snapshot
 };
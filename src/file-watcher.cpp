@@ -1,29 +1,79 @@
 #include "file-watcher.hpp"
+#include <algorithm>
 #include <fstream>
 #include <sstream>
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
 
-FileWatcher::FileWatcher(int pollIntervalMs)
-    : m_pollIntervalMs(pollIntervalMs) {
+FileWatcher::FileWatcher() {
+  m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
   m_thread = std::thread(&FileWatcher::runLoop, this);
 }
 
 FileWatcher::~FileWatcher() {
   stop();
+  if (m_inotifyFd >= 0) close(m_inotifyFd);
+  if (m_wakeFd >= 0) close(m_wakeFd);
 }
 
 void FileWatcher::watch(
     const std::string& path,
     Callback callback) {
+  // Watch the parent directory rather than the file itself so the
+  // watch survives the file being created, replaced or renamed over.
+  auto slash = path.find_last_of('/');
+  std::string dir = slash == std::string::npos ? "." : path.substr(0, slash);
+  if (dir.empty()) dir = "/";
+
   std::lock_guard<std::mutex> lock(m_mutex);
   WatchEntry entry;
   entry.path = path;
+  entry.name = path.substr(slash == std::string::npos ? 0 : slash + 1);
+  entry.wd = inotify_add_watch(
+      m_inotifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
   entry.lastContent = readFile(path);
   entry.callback = callback;
   m_watches.push_back(entry);
 }
 
+int FileWatcher::watchDirectory(
+    const std::string& dir,
+    DirectoryCallback callback) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  DirectoryEntry entry;
+  entry.wd = inotify_add_watch(
+      m_inotifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+  if (entry.wd < 0) return -1;
+  entry.callback = callback;
+  m_directories.push_back(entry);
+  return entry.wd;
+}
+
+void FileWatcher::unwatchDirectory(int handle) {
+  if (handle < 0) return;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::erase_if(m_directories, [handle](const DirectoryEntry& entry) {
+    return entry.wd == handle;
+  });
+
+  // inotify hands out one descriptor per inode, so a watched file in
+  // the same directory shares it; keep the watch while it does.
+  bool shared = std::any_of(
+      m_watches.begin(), m_watches.end(),
+      [handle](const WatchEntry& entry) { return entry.wd == handle; });
+  if (!shared) inotify_rm_watch(m_inotifyFd, handle);
+}
+
 void FileWatcher::stop() {
   m_running = false;
+  if (m_wakeFd >= 0) {
+    uint64_t one = 1;
+    write(m_wakeFd, &one, sizeof(one));
+  }
   if (m_thread.joinable()) {
     m_thread.join();
   }
@@ -38,17 +88,65 @@ std::string FileWatcher::readFile(const std::string& path) {
 }
 
 void FileWatcher::runLoop() {
+  pollfd fds[2] = {
+    {m_inotifyFd, POLLIN, 0},
+    {m_wakeFd, POLLIN, 0},
+  };
+
   while (m_running) {
-    std::this_thread::sleep_for(
-        std::chrono::milliseconds(m_pollIntervalMs));
-
-    std::lock_guard<std::mutex> lock(m_mutex);
-    for (auto& entry : m_watches) {
-      std::string content = readFile(entry.path);
-      if (content != entry.lastContent) {
-        entry.lastContent = content;
-        entry.callback(content);
+    // Block until inotify reports a write or stop() wakes us up.
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    if (fds[1].revents & POLLIN) break;
+    if (fds[0].revents & POLLIN) handleEvents();
+  }
+}
+
+void FileWatcher::handleEvents() {
+  alignas(inotify_event) char buf[4096];
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  // Drain every queued event first so a burst of writes to one file
+  // only costs a single read of its contents.
+  ssize_t len;
+  while ((len = read(m_inotifyFd, buf, sizeof(buf))) > 0) {
+    for (char* p = buf; p < buf + len;) {
+      auto* event = reinterpret_cast<inotify_event*>(p);
+      p += sizeof(inotify_event) + event->len;
+      if (event->len == 0) continue;
+
+      for (auto& entry : m_watches) {
+        if (entry.wd == event->wd && entry.name == event->name) {
+          entry.changed = true;
+        }
+      }
+      for (auto& entry : m_directories) {
+        if (entry.wd != event->wd) continue;
+        auto& changed = entry.changed;
+        if (std::find(changed.begin(), changed.end(), event->name) ==
+            changed.end()) {
+          changed.push_back(event->name);
+        }
       }
     }
   }
+
+  for (auto& entry : m_directories) {
+    if (entry.changed.empty()) continue;
+    entry.callback(entry.changed);
+    entry.changed.clear();
+  }
+
+  for (auto& entry : m_watches) {
+    if (!entry.changed) continue;
+    entry.changed = false;
+
+    std::string content = readFile(entry.path);
+    if (content != entry.lastContent) {
+      entry.lastContent = content;
+      entry.callback(content);
+    }
+  }
 }
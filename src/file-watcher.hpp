@@ -4,16 +4,21 @@
 #include <functional>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <vector>
 
 /**
  * Watches files for changes and triggers callbacks.
- * Runs in a background thread with configurable poll interval.
+ * Runs in a background thread blocked on inotify, so it
+ * only wakes up when a watched file is written.
  */
 class FileWatcher {
  public:
   using Callback = std::function<void(const std::string&)>;
+  using DirectoryCallback =
+      std::function<void(const std::vector<std::string>&)>;
 
-  FileWatcher(int pollIntervalMs = 10);
+  FileWatcher();
   ~FileWatcher();
 
   /**
@@ -21,6 +26,18 @@ class FileWatcher {
    */
   void watch(const std::string& path, Callback callback);
 
+  /**
+   * Watches a directory and calls callback with the names of files
+   * written or moved into it. A burst of changes is delivered as
+   * one call. Returns a handle for unwatchDirectory(), or -1.
+   */
+  int watchDirectory(const std::string& dir, DirectoryCallback callback);
+
+  /**
+   * Stops watching a directory added by watchDirectory().
+   */
+  void unwatchDirectory(int handle);
+
   /**
    * Stops the watcher thread.
    */
@@ -28,17 +45,29 @@ class FileWatcher {
 
  private:
   void runLoop();
+  void handleEvents();
   std::string readFile(const std::string& path);
 
   struct WatchEntry {
     std::string path;
+    std::string name;
+    int wd = -1;
+    bool changed = false;
     std::string lastContent;
     Callback callback;
   };
 
+  struct DirectoryEntry {
+    int wd = -1;
+    std::vector<std::string> changed;
+    DirectoryCallback callback;
+  };
+
   std::vector<WatchEntry> m_watches;
+  std::vector<DirectoryEntry> m_directories;
   std::thread m_thread;
   std::atomic<bool> m_running{true};
-  int m_pollIntervalMs;
+  int m_inotifyFd = -1;
+  int m_wakeFd = -1;
   std::mutex m_mutex;
 };
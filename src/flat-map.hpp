@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * Open-addressing hash map for integer keys.
+ * Linear probing over a power-of-two table with backward-shift
+ * deletion, so there are no tombstones and lookups scan one short
+ * contiguous run. Key 0 is reserved as the empty marker; lookups
+ * never allocate, inserts only when the table grows.
+ */
+template <typename K, typename V>
+class FlatMap {
+ public:
+  V* find(K key) {
+    if (m_size == 0) return nullptr;
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = indexFor(key);; i = (i + 1) & mask) {
+      Slot& slot = m_slots[i];
+      if (slot.key == key) return &slot.value;
+      if (slot.key == K{}) return nullptr;
+    }
+  }
+
+  const V* find(K key) const {
+    return const_cast<FlatMap*>(this)->find(key);
+  }
+
+  bool contains(K key) const { return find(key) != nullptr; }
+
+  /**
+   * Returns the value for key, default-constructing it if missing.
+   */
+  V& operator[](K key) {
+    if ((m_size + 1) * 4 > m_slots.size() * 3) grow();
+
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = indexFor(key);; i = (i + 1) & mask) {
+      Slot& slot = m_slots[i];
+      if (slot.key == key) return slot.value;
+      if (slot.key == K{}) {
+        slot.key = key;
+        ++m_size;
+        return slot.value;
+      }
+    }
+  }
+
+  /**
+   * Inserts key with a default value. Returns false if present.
+   */
+  bool insert(K key) {
+    if (contains(key)) return false;
+    (*this)[key];
+    return true;
+  }
+
+  bool erase(K key) {
+    if (m_size == 0) return false;
+    size_t mask = m_slots.size() - 1;
+    size_t i = indexFor(key);
+    while (m_slots[i].key != key) {
+      if (m_slots[i].key == K{}) return false;
+      i = (i + 1) & mask;
+    }
+
+    // Shift later members of the probe run back into the hole so
+    // every remaining key stays reachable from its home slot.
+    for (size_t j = (i + 1) & mask; m_slots[j].key != K{};
+         j = (j + 1) & mask) {
+      size_t home = indexFor(m_slots[j].key);
+      bool inRange = i <= j ? (home > i && home <= j)
+                            : (home > i || home <= j);
+      if (!inRange) {
+        m_slots[i] = std::move(m_slots[j]);
+        i = j;
+      }
+    }
+
+    m_slots[i] = Slot{};
+    --m_size;
+    return true;
+  }
+
+  void clear() {
+    if (m_size == 0) return;
+    for (auto& slot : m_slots) slot = Slot{};
+    m_size = 0;
+  }
+
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  /**
+   * Calls fn(key, value) for every entry. Must not modify the map.
+   */
+  template <typename Fn>
+  void forEach(Fn&& fn) {
+    if (m_size == 0) return;
+    for (auto& slot : m_slots) {
+      if (slot.key != K{}) fn(slot.key, slot.value);
+    }
+  }
+
+  template <typename Fn>
+  void forEach(Fn&& fn) const {
+    if (m_size == 0) return;
+    for (const auto& slot : m_slots) {
+      if (slot.key != K{}) fn(slot.key, slot.value);
+    }
+  }
+
+ private:
+  struct Slot {
+    K key{};
+    V value{};
+  };
+
+  size_t indexFor(K key) const {
+    // Fibonacci hashing spreads pointer-like keys whose low bits are
+    // always zero due to alignment.
+    return (size_t)(((uint64_t)key * 0x9E3779B97F4A7C15ull) >> m_shift);
+  }
+
+  void grow() {
+    std::vector<Slot> old = std::move(m_slots);
+    size_t capacity = old.empty() ? 16 : old.size() * 2;
+    m_slots.assign(capacity, Slot{});
+    m_shift = 64 - __builtin_ctzll(capacity);
+    m_size = 0;
+
+    for (auto& slot : old) {
+      if (slot.key != K{}) (*this)[slot.key] = std::move(slot.value);
+    }
+  }
+
+  std::vector<Slot> m_slots;
+  size_t m_size = 0;
+  unsigned m_shift = 64;
+};
+
+/**
+ * Set of integer keys with the same layout as FlatMap.
+ */
+template <typename K>
+using FlatSet = FlatMap<K, bool>;
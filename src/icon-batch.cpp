@@ -0,0 +1,149 @@
+#include "icon-batch.hpp"
+#include "texture-cache.hpp"
+#include "render-utils.hpp"
+
+static const char* VERTEX_SHADER = R"#(#version 300 es
+precision highp float;
+uniform mat3 proj;
+in vec2 pos;
+in vec2 texcoord;
+in vec4 tint;
+out vec2 v_texcoord;
+out vec4 v_tint;
+
+void main() {
+  gl_Position = vec4(proj * vec3(pos, 1.0), 1.0);
+  v_texcoord = texcoord;
+  v_tint = tint;
+}
+)#";
+
+static const char* FRAGMENT_SHADER = R"#(#version 300 es
+precision highp float;
+uniform sampler2D tex;
+in vec2 v_texcoord;
+in vec4 v_tint;
+layout(location = 0) out vec4 fragColor;
+
+void main() {
+  // Textures and tint are premultiplied, so scale every channel.
+  fragColor = texture(tex, v_texcoord) * v_tint;
+}
+)#";
+
+IconBatch& IconBatch::get() {
+  static IconBatch instance;
+  return instance;
+}
+
+void IconBatch::add(
+    const TextureRegion& region,
+    const CBox& box,
+    float alpha) {
+  push(region, box, alpha, alpha, alpha, alpha);
+}
+
+void IconBatch::add(
+    const TextureRegion& region,
+    const CBox& box,
+    const CHyprColor& color) {
+  float a = color.a;
+  push(region, box, color.r * a, color.g * a, color.b * a, a);
+}
+
+void IconBatch::push(
+    const TextureRegion& region,
+    const CBox& box,
+    float r, float g, float b, float a) {
+  if (!region.texture || a <= 0.0f) return;
+
+  GLuint texture = region.texture->m_texID;
+  if (m_runs.empty() || m_runs.back().texture != texture) {
+    m_runs.push_back({texture, m_vertices.size(), 0});
+  }
+
+  float x0 = box.x, y0 = box.y;
+  float x1 = box.x + box.w, y1 = box.y + box.h;
+  float u0 = region.uvTopLeft.x, v0 = region.uvTopLeft.y;
+  float u1 = region.uvBottomRight.x, v1 = region.uvBottomRight.y;
+
+  m_vertices.push_back({x0, y0, u0, v0, r, g, b, a});
+  m_vertices.push_back({x1, y0, u1, v0, r, g, b, a});
+  m_vertices.push_back({x0, y1, u0, v1, r, g, b, a});
+  m_vertices.push_back({x1, y0, u1, v0, r, g, b, a});
+  m_vertices.push_back({x1, y1, u1, v1, r, g, b, a});
+  m_vertices.push_back({x0, y1, u0, v1, r, g, b, a});
+  m_runs.back().count += 6;
+}
+
+bool IconBatch::initGL() {
+  if (m_program) return true;
+  if (m_glFailed) return false;
+
+  m_program = render::compileProgram(VERTEX_SHADER, FRAGMENT_SHADER);
+  if (!m_program) {
+    m_glFailed = true;
+    return false;
+  }
+
+  m_projLoc = glGetUniformLocation(m_program, "proj");
+  m_texLoc = glGetUniformLocation(m_program, "tex");
+  GLint posLoc = glGetAttribLocation(m_program, "pos");
+  GLint uvLoc = glGetAttribLocation(m_program, "texcoord");
+  GLint tintLoc = glGetAttribLocation(m_program, "tint");
+
+  glGenVertexArrays(1, &m_vao);
+  glGenBuffers(1, &m_vbo);
+  glBindVertexArray(m_vao);
+  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+
+  glEnableVertexAttribArray(posLoc);
+  glVertexAttribPointer(posLoc, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                        (void*)offsetof(Vertex, x));
+  glEnableVertexAttribArray(uvLoc);
+  glVertexAttribPointer(uvLoc, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                        (void*)offsetof(Vertex, u));
+  glEnableVertexAttribArray(tintLoc);
+  glVertexAttribPointer(tintLoc, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                        (void*)offsetof(Vertex, r));
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  return true;
+}
+
+void IconBatch::flush() {
+  if (m_vertices.empty() || !initGL()) {
+    m_vertices.clear();
+    m_runs.clear();
+    return;
+  }
+
+  auto proj = render::pixelProjection();
+
+  g_pHyprOpenGL->blend(true);
+  glUseProgram(m_program);
+  glUniformMatrix3fv(m_projLoc, 1, GL_TRUE, proj.data());
+  glUniform1i(m_texLoc, 0);
+  glActiveTexture(GL_TEXTURE0);
+
+  glBindVertexArray(m_vao);
+  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+  glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(Vertex),
+               m_vertices.data(), GL_STREAM_DRAW);
+
+  render::forEachDamageRect([this] {
+    for (const auto& run : m_runs) {
+      glBindTexture(GL_TEXTURE_2D, run.texture);
+      glDrawArrays(GL_TRIANGLES, run.first, run.count);
+    }
+  });
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+  glUseProgram(0);
+
+  m_vertices.clear();
+  m_runs.clear();
+}
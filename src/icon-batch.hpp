@@ -0,0 +1,66 @@
+#pragma once
+
+#include <hyprland/src/render/OpenGL.hpp>
+#include <vector>
+
+struct TextureRegion;
+
+/**
+ * Collects textured quads and draws them with one call per texture.
+ * Icons packed into the same atlas page therefore cost a single
+ * bind and draw no matter how many are on screen. Buffers are kept
+ * between flushes, so steady-state batching does not allocate.
+ */
+class IconBatch {
+ public:
+  static IconBatch& get();
+
+  /**
+   * Queues region drawn into box (monitor-local pixels).
+   */
+  void add(const TextureRegion& region, const CBox& box, float alpha);
+
+  /**
+   * Queues region tinted by color; used for white text coverage.
+   */
+  void add(
+      const TextureRegion& region,
+      const CBox& box,
+      const CHyprColor& color);
+
+  /**
+   * Draws everything queued, in submission order, and resets.
+   */
+  void flush();
+
+ private:
+  IconBatch() = default;
+
+  bool initGL();
+  void push(
+      const TextureRegion& region,
+      const CBox& box,
+      float r, float g, float b, float a);
+
+  struct Vertex {
+    float x, y;
+    float u, v;
+    float r, g, b, a;  // Premultiplied tint
+  };
+
+  struct Run {
+    GLuint texture;
+    size_t first;
+    size_t count;
+  };
+
+  std::vector<Vertex> m_vertices;
+  std::vector<Run> m_runs;
+
+  GLuint m_program = 0;
+  GLuint m_vao = 0;
+  GLuint m_vbo = 0;
+  GLint m_projLoc = -1;
+  GLint m_texLoc = -1;
+  bool m_glFailed = false;
+};
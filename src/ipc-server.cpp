@@ -0,0 +1,236 @@
+#include "ipc-server.hpp"
+#include "config.hpp"
+#include "shm-ring.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+static int handleListenEvent(int fd, uint32_t mask, void* data) {
+  return ((IpcServer*)data)->onListenEvent(fd, mask);
+}
+
+static int handleClientEvent(int fd, uint32_t mask, void* data) {
+  return ((IpcServer*)data)->onClientEvent(fd, mask);
+}
+
+static int handleRingEvent(int fd, uint32_t mask, void* data) {
+  return ((IpcServer*)data)->onRingEvent(fd, mask);
+}
+
+IpcServer::IpcServer(
+    CommandHandler onCommands,
+    RecordHandler onRecord,
+    BatchHandler onBatchEnd)
+    : m_onCommands(std::move(onCommands)),
+      m_onRecord(std::move(onRecord)),
+      m_onBatchEnd(std::move(onBatchEnd)) {}
+
+IpcServer::~IpcServer() {
+  stop();
+}
+
+bool IpcServer::start(wl_event_loop* loop, const std::string& path) {
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) return false;
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+  m_listenFd = socket(
+      AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (m_listenFd < 0) return false;
+
+  // A previous compositor session may have left a stale socket behind.
+  unlink(path.c_str());
+
+  if (bind(m_listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+      listen(m_listenFd, SOMAXCONN) != 0) {
+    close(m_listenFd);
+    m_listenFd = -1;
+    return false;
+  }
+
+  m_loop = loop;
+  m_path = path;
+  m_listenSource = wl_event_loop_add_fd(
+      loop, m_listenFd, WL_EVENT_READABLE, handleListenEvent, this);
+  return true;
+}
+
+void IpcServer::stop() {
+  while (!m_clients.empty()) {
+    closeClient(m_clients.begin()->first);
+  }
+
+  if (m_listenSource) {
+    wl_event_source_remove(m_listenSource);
+    m_listenSource = nullptr;
+  }
+  if (m_listenFd >= 0) {
+    close(m_listenFd);
+    m_listenFd = -1;
+    unlink(m_path.c_str());
+  }
+}
+
+int IpcServer::onListenEvent(int fd, uint32_t mask) {
+  if (mask & WL_EVENT_READABLE) acceptClients();
+  return 0;
+}
+
+void IpcServer::acceptClients() {
+  while (true) {
+    int fd = accept4(m_listenFd, nullptr, nullptr,
+                     SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) return;
+
+    Client& client = m_clients[fd];
+    client.source = wl_event_loop_add_fd(
+        m_loop, fd, WL_EVENT_READABLE, handleClientEvent, this);
+  }
+}
+
+void IpcServer::closeClient(int fd) {
+  auto it = m_clients.find(fd);
+  if (it == m_clients.end()) return;
+
+  if (it->second.source) wl_event_source_remove(it->second.source);
+  if (it->second.ringSource) {
+    wl_event_source_remove(it->second.ringSource);
+    m_ringOwners.erase(it->second.ring->eventFd());
+  }
+  close(fd);
+  m_clients.erase(it);
+}
+
+int IpcServer::onClientEvent(int fd, uint32_t mask) {
+  auto it = m_clients.find(fd);
+  if (it == m_clients.end()) return 0;
+  Client& client = it->second;
+
+  bool closed = false;
+  char buf[4096];
+
+  // A client that never stops writing must not hold the main thread
+  // or grow its buffer without bound. The fd stays readable, so the
+  // rest is read on the next dispatch.
+  size_t budget = config::IPC_MAX_READ_BYTES;
+  while (budget > 0) {
+    ssize_t len = read(fd, buf, std::min(sizeof(buf), budget));
+    if (len > 0) {
+      client.buffer.append(buf, len);
+      budget -= len;
+      continue;
+    }
+    if (len < 0 && errno == EINTR) continue;
+    if (len == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+      closed = true;
+    }
+    break;
+  }
+  // Whatever is still unread after a hangup comes next time.
+  if (budget > 0 && (mask & (WL_EVENT_HANGUP | WL_EVENT_ERROR))) {
+    closed = true;
+  }
+
+  // Hand over every complete line; keep a trailing partial command
+  // buffered until the rest of it arrives.
+  auto end = client.buffer.find_last_of('\n');
+  if (closed) {
+    end = client.buffer.size();
+  } else if (end != std::string::npos) {
+    ++end;
+  }
+
+  if (end != std::string::npos && end > 0) {
+    dispatchLines(fd, std::string_view(client.buffer).substr(0, end));
+    client.buffer.erase(0, end);
+    m_onBatchEnd();
+  }
+
+  if (closed || client.buffer.size() > config::IPC_MAX_LINE_BYTES) {
+    closeClient(fd);
+  }
+  return 0;
+}
+
+void IpcServer::dispatchLines(int fd, std::string_view lines) {
+  // Control lines are handled here; runs of ordinary commands between
+  // them are forwarded to the command handler in one piece.
+  size_t runStart = 0;
+  size_t pos = 0;
+  while (pos < lines.size()) {
+    size_t eol = lines.find('\n', pos);
+    size_t next = eol == std::string_view::npos ? lines.size() : eol + 1;
+    std::string_view line = lines.substr(pos, next - pos);
+    while (!line.empty() &&
+           (line.back() == '\n' || line.back() == '\r')) {
+      line.remove_suffix(1);
+    }
+
+    if (line == "ring-attach") {
+      if (pos > runStart) {
+        m_onCommands(lines.substr(runStart, pos - runStart));
+      }
+      attachRing(fd, m_clients[fd]);
+      runStart = next;
+    }
+    pos = next;
+  }
+
+  if (lines.size() > runStart) {
+    m_onCommands(lines.substr(runStart));
+  }
+}
+
+bool IpcServer::attachRing(int fd, Client& client) {
+  if (client.ring) return false;
+
+  auto ring = std::make_unique<ShmRing>();
+  if (!ring->create(ring::DEFAULT_CAPACITY)) return false;
+
+  // Reply "ring <capacity> <record size>" with the memfd and the
+  // eventfd attached, in that order.
+  std::string reply = std::format(
+      "ring {} {}\n", ring->capacity(), sizeof(OverlayCommand));
+  iovec iov = {reply.data(), reply.size()};
+
+  int fds[2] = {ring->memFd(), ring->eventFd()};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+
+  msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+  std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+  if (sendmsg(fd, &msg, MSG_NOSIGNAL) < 0) return false;
+
+  client.ringSource = wl_event_loop_add_fd(
+      m_loop, ring->eventFd(), WL_EVENT_READABLE, handleRingEvent, this);
+  m_ringOwners[ring->eventFd()] = fd;
+  client.ring = std::move(ring);
+  return true;
+}
+
+int IpcServer::onRingEvent(int fd, uint32_t mask) {
+  auto owner = m_ringOwners.find(fd);
+  if (owner == m_ringOwners.end()) return 0;
+
+  auto it = m_clients.find(owner->second);
+  if (it == m_clients.end() || !it->second.ring) return 0;
+
+  size_t count = it->second.ring->drain(
+      [this](const OverlayCommand& cmd) { m_onRecord(cmd); });
+  if (count > 0) m_onBatchEnd();
+  return 0;
+}
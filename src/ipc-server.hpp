@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <unordered_map>
+#include <memory>
+#include <wayland-server.h>
+#include "command.hpp"
+
+class ShmRing;
+
+/**
+ * Unix domain socket command listener.
+ * Runs on the compositor event loop: clients send newline
+ * terminated commands and complete lines are handed to the
+ * command handler on the main thread.
+ *
+ * A client may send `ring-attach` to receive a memfd-backed
+ * command ring plus an eventfd over SCM_RIGHTS; records it
+ * publishes there bypass text parsing entirely.
+ */
+class IpcServer {
+ public:
+  using CommandHandler = std::function<void(std::string_view)>;
+  using RecordHandler = std::function<void(const OverlayCommand&)>;
+  using BatchHandler = std::function<void()>;
+
+  IpcServer(
+      CommandHandler onCommands,
+      RecordHandler onRecord,
+      BatchHandler onBatchEnd);
+  ~IpcServer();
+
+  /**
+   * Binds the socket at path and registers it with the event loop.
+   */
+  bool start(wl_event_loop* loop, const std::string& path);
+
+  /**
+   * Disconnects all clients and removes the socket.
+   */
+  void stop();
+
+  /**
+   * Handles readiness on the listening socket.
+   */
+  int onListenEvent(int fd, uint32_t mask);
+
+  /**
+   * Handles readiness on a client connection.
+   */
+  int onClientEvent(int fd, uint32_t mask);
+
+  /**
+   * Drains a client's command ring after its eventfd fired.
+   */
+  int onRingEvent(int fd, uint32_t mask);
+
+ private:
+  struct Client {
+    wl_event_source* source = nullptr;
+    std::string buffer;
+    std::unique_ptr<ShmRing> ring;
+    wl_event_source* ringSource = nullptr;
+  };
+
+  void acceptClients();
+  void closeClient(int fd);
+  void dispatchLines(int fd, std::string_view lines);
+  bool attachRing(int fd, Client& client);
+
+  CommandHandler m_onCommands;
+  RecordHandler m_onRecord;
+  BatchHandler m_onBatchEnd;
+
+  wl_event_loop* m_loop = nullptr;
+  wl_event_source* m_listenSource = nullptr;
+  int m_listenFd = -1;
+  std::string m_path;
+  std::unordered_map<int, Client> m_clients;
+  std::unordered_map<int, int> m_ringOwners;  // eventfd -> client fd
+};
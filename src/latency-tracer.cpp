@@ -0,0 +1,101 @@
+#include "latency-tracer.hpp"
+#include <algorithm>
+#include <vector>
+
+static int64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static LatencyTracer::Span summarize(std::vector<int64_t>& samples) {
+  LatencyTracer::Span span;
+  if (samples.empty()) return span;
+  std::sort(samples.begin(), samples.end());
+
+  auto at = [&samples](double q) {
+    return samples[(size_t)(q * (samples.size() - 1))] / 1e3;
+  };
+  span.count = samples.size();
+  span.p50Us = at(0.5);
+  span.p90Us = at(0.9);
+  span.p99Us = at(0.99);
+  span.maxUs = samples.back() / 1e3;
+  return span;
+}
+
+LatencyTracer& LatencyTracer::get() {
+  static LatencyTracer instance;
+  return instance;
+}
+
+TraceId LatencyTracer::begin(
+    uint64_t seq,
+    int64_t sentUs,
+    std::chrono::steady_clock::time_point read) {
+  TraceId id = m_next.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (id == 0) id = m_next.fetch_add(1, std::memory_order_relaxed) + 1;
+
+  // Hide the slot while it is reset so late stamps for its previous
+  // trace are dropped rather than mixed in.
+  Record& record = recordFor(id);
+  record.id.store(0, std::memory_order_relaxed);
+  record.seq.store(seq, std::memory_order_relaxed);
+  for (auto& stage : record.stages) stage.store(0, std::memory_order_relaxed);
+
+  record.stages[(size_t)TraceStage::SENT].store(
+      sentUs * 1000, std::memory_order_relaxed);
+  record.stages[(size_t)TraceStage::READ].store(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          read.time_since_epoch()).count(),
+      std::memory_order_relaxed);
+  record.id.store(id, std::memory_order_release);
+  return id;
+}
+
+void LatencyTracer::mark(TraceId id, TraceStage stage) {
+  Record& record = recordFor(id);
+  if (id == 0 || record.id.load(std::memory_order_acquire) != id) return;
+
+  auto& cell = record.stages[(size_t)stage];
+  if (cell.load(std::memory_order_relaxed) == 0) {
+    cell.store(nowNs(), std::memory_order_relaxed);
+  }
+}
+
+LatencyTracer::Report LatencyTracer::report() const {
+  Report report;
+  std::array<std::vector<int64_t>, TRACE_STAGE_COUNT> deltas;
+  std::vector<int64_t> totals;
+  int64_t slowest = -1;
+
+  for (const auto& record : m_records) {
+    if (record.id.load(std::memory_order_acquire) == 0) continue;
+
+    std::array<int64_t, TRACE_STAGE_COUNT> t;
+    for (size_t i = 0; i < TRACE_STAGE_COUNT; ++i) {
+      t[i] = record.stages[i].load(std::memory_order_relaxed);
+    }
+    int64_t rendered = t[(size_t)TraceStage::RENDERED];
+    if (rendered == 0) continue;
+
+    ++report.traces;
+    for (size_t i = 1; i < TRACE_STAGE_COUNT; ++i) {
+      if (t[i] != 0 && t[i - 1] != 0) deltas[i].push_back(t[i] - t[i - 1]);
+    }
+
+    auto first = std::find_if(
+        t.begin(), t.end(), [](int64_t stamp) { return stamp != 0; });
+    int64_t total = rendered - *first;
+    totals.push_back(total);
+    if (total > slowest) {
+      slowest = total;
+      report.slowestSeq = record.seq.load(std::memory_order_relaxed);
+    }
+  }
+
+  for (size_t i = 1; i < TRACE_STAGE_COUNT; ++i) {
+    report.stages[i] = summarize(deltas[i]);
+  }
+  report.total = summarize(totals);
+  return report;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "config.hpp"
+
+/**
+ * Handle of one traced command; 0 means untraced.
+ */
+using TraceId = uint32_t;
+
+/**
+ * Points a traced command passes on its way to the screen.
+ */
+enum class TraceStage : uint8_t {
+  SENT,      // Client timestamp, when the client gave one
+  READ,      // Text handed to the parser
+  PARSED,    // Line parsed
+  APPLIED,   // Applied to the model on the main thread
+  DAMAGED,   // Damage submitted for its window
+  RENDERED,  // First render pass of that window afterwards
+  COUNT,
+};
+
+constexpr size_t TRACE_STAGE_COUNT = (size_t)TraceStage::COUNT;
+
+/**
+ * End-to-end latency of client-tagged commands.
+ *
+ * A line prefixed with `@<seq>` or `@<seq>:<monotonic µs>` starts a
+ * trace; each stage it passes is stamped into a fixed ring of the
+ * last TRACE_CAPACITY traces, overwriting the oldest. Untagged
+ * commands cost nothing.
+ *
+ * Stages are stamped from the watcher and main threads; a stamp for
+ * a trace that has since been overwritten is ignored.
+ */
+class LatencyTracer {
+ public:
+  struct Span {
+    uint64_t count = 0;
+    double p50Us = 0;
+    double p90Us = 0;
+    double p99Us = 0;
+    double maxUs = 0;
+  };
+
+  struct Report {
+    uint64_t traces = 0;  // Completed traces in the ring
+    // Time from the previous stage to each one; SENT is unused.
+    std::array<Span, TRACE_STAGE_COUNT> stages;
+    Span total;           // First stamp to RENDERED
+    uint64_t slowestSeq = 0;
+  };
+
+  static LatencyTracer& get();
+
+  /**
+   * Starts a trace for client sequence number seq. sentUs is the
+   * client's CLOCK_MONOTONIC timestamp in microseconds, or 0.
+   */
+  TraceId begin(
+      uint64_t seq,
+      int64_t sentUs,
+      std::chrono::steady_clock::time_point read);
+
+  /**
+   * Stamps stage with the current time. Only the first stamp of a
+   * stage counts.
+   */
+  void mark(TraceId id, TraceStage stage);
+
+  /**
+   * Summarizes the completed traces.
+   */
+  Report report() const;
+
+ private:
+  LatencyTracer() = default;
+
+  struct Record {
+    std::atomic<TraceId> id{0};
+    std::atomic<uint64_t> seq{0};
+    // Steady clock nanoseconds; 0 when the stage was not reached.
+    std::array<std::atomic<int64_t>, TRACE_STAGE_COUNT> stages{};
+  };
+
+  Record& recordFor(TraceId id) {
+    return m_records[id % config::TRACE_CAPACITY];
+  }
+
+  std::array<Record, config::TRACE_CAPACITY> m_records;
+  std::atomic<TraceId> m_next{0};
+};
@@ -0,0 +1,181 @@
+#include "logger.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+Logger& Logger::get() {
+  static Logger instance;
+  return instance;
+}
+
+Logger::~Logger() {
+  stop();
+  if (m_fd >= 0) close(m_fd);
+}
+
+void Logger::start() {
+  if (m_thread.joinable()) return;
+  m_stopping = false;
+  m_thread = std::thread([this] { run(); });
+}
+
+void Logger::stop() {
+  if (m_thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(m_wakeMutex);
+      m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+  }
+  // Anything logged while the writer was shutting down.
+  drain();
+}
+
+bool Logger::admit(const char* site, Entry& entry) {
+  // Slots are shared by call sites that hash alike, which only makes
+  // the limit a little stricter for both.
+  auto& slot = m_rates[((uintptr_t)site >> 4) % m_rates.size()];
+  int64_t second = std::chrono::duration_cast<std::chrono::seconds>(
+      entry.time.time_since_epoch()).count();
+
+  bool otherSite = slot.site.exchange(site, std::memory_order_relaxed) != site;
+  bool newSecond =
+      slot.second.exchange(second, std::memory_order_relaxed) != second;
+  if (otherSite || newSecond) {
+    slot.count.store(0, std::memory_order_relaxed);
+    entry.suppressed = slot.suppressed.exchange(0, std::memory_order_relaxed);
+  }
+
+  if (slot.count.fetch_add(1, std::memory_order_relaxed) >=
+      config::LOG_RATE_PER_SECOND) {
+    slot.suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+void Logger::push(const Entry& entry) {
+  bool urgent = entry.level >= LogLevel::WARN;
+  if (!m_queue.push(entry)) {
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    urgent = true;
+  }
+  raise(m_pending);
+  if (urgent) raise(m_urgent);
+}
+
+void Logger::raise(std::atomic<bool>& flag) {
+  // Only the first raise since the writer cleared the flag notifies.
+  // Passing through the mutex orders it against the writer's
+  // predicate check, so the notify can't slip in before the wait.
+  if (flag.exchange(true, std::memory_order_acq_rel)) return;
+  { std::lock_guard<std::mutex> lock(m_wakeMutex); }
+  m_wake.notify_one();
+}
+
+void Logger::run() {
+  while (true) {
+    bool stopping;
+    {
+      std::unique_lock<std::mutex> lock(m_wakeMutex);
+      m_wake.wait(lock, [this] {
+        return m_stopping || m_pending.load(std::memory_order_relaxed);
+      });
+      // Something is queued: give more messages a chance to join the
+      // batch unless one of them wants out now.
+      m_wake.wait_for(
+          lock, std::chrono::milliseconds(config::LOG_FLUSH_MS), [this] {
+            return m_stopping || m_urgent.load(std::memory_order_relaxed);
+          });
+      stopping = m_stopping;
+    }
+    // Cleared before draining, so a message queued meanwhile raises
+    // the flag again; the exchange makes every entry pushed before
+    // the matching raise visible to the drain.
+    m_pending.exchange(false, std::memory_order_acq_rel);
+    m_urgent.exchange(false, std::memory_order_acq_rel);
+    drain();
+    if (stopping) return;
+  }
+}
+
+void Logger::drain() {
+  Entry entry;
+  while (m_queue.pop(entry)) append(entry);
+
+  uint64_t dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+  if (dropped > 0) {
+    m_batch += "[log queue full, dropped " + std::to_string(dropped) +
+               " messages]\n";
+  }
+  writeBatch();
+}
+
+void Logger::append(const Entry& entry) {
+  static const char* const LEVELS[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+
+  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      entry.time.time_since_epoch()).count();
+  time_t seconds = ms / 1000;
+  tm local;
+  localtime_r(&seconds, &local);
+
+  char prefix[48];
+  int length = std::snprintf(
+      prefix, sizeof(prefix), "%02d:%02d:%02d.%03d %-5s ", local.tm_hour,
+      local.tm_min, local.tm_sec, (int)(ms % 1000),
+      LEVELS[std::min((int)entry.level, 3)]);
+  m_batch.append(prefix, length);
+  m_batch.append(entry.text, entry.length);
+  if (entry.suppressed > 0) {
+    m_batch += " [" + std::to_string(entry.suppressed) +
+               " similar suppressed]";
+  }
+  m_batch += '\n';
+}
+
+bool Logger::openFile() {
+  m_fd = open(config::LOG_FILE.c_str(),
+              O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (m_fd < 0) return false;
+
+  struct stat st;
+  m_fileBytes = fstat(m_fd, &st) == 0 ? st.st_size : 0;
+  return true;
+}
+
+void Logger::writeBatch() {
+  if (m_batch.empty()) return;
+  if (m_fd < 0 && !openFile()) {
+    m_batch.clear();
+    return;
+  }
+
+  if (m_fileBytes > 0 &&
+      m_fileBytes + m_batch.size() > config::LOG_MAX_FILE_BYTES) {
+    close(m_fd);
+    rename(config::LOG_FILE.c_str(), (config::LOG_FILE + ".1").c_str());
+    if (!openFile()) {
+      m_batch.clear();
+      return;
+    }
+  }
+
+  const char* data = m_batch.data();
+  size_t left = m_batch.size();
+  while (left > 0) {
+    ssize_t written = write(m_fd, data, left);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    data += written;
+    left -= written;
+    m_fileBytes += written;
+  }
+  m_batch.clear();
+}
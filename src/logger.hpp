@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <format>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "types.hpp"
+#include "config.hpp"
+#include "mpsc-queue.hpp"
+
+// Messages below this level are compiled out, arguments and all.
+// 0 = debug ... 4 = off; set through the SUPERGLUE_LOG_LEVEL option.
+#ifndef SUPERGLUE_LOG_LEVEL
+#define SUPERGLUE_LOG_LEVEL 0
+#endif
+
+/**
+ * Asynchronous log to config::LOG_FILE.
+ *
+ * log() formats into a fixed-size record and pushes it onto a
+ * lock-free queue. A background thread sleeps until something is
+ * queued, lets the batch fill for LOG_FLUSH_MS (warnings cut that
+ * short) and writes it with one write(2); with nothing logged it
+ * never wakes. The file is rotated to LOG_FILE.1 once it reaches
+ * LOG_MAX_FILE_BYTES.
+ *
+ * Each call site (format string) may log LOG_RATE_PER_SECOND messages
+ * a second; the rest are counted and reported with the next one that
+ * gets through. When the queue is full, messages are dropped and
+ * counted rather than blocking the caller.
+ *
+ * Safe from any thread.
+ */
+class Logger {
+ public:
+  static constexpr LogLevel COMPILED_LEVEL = (LogLevel)SUPERGLUE_LOG_LEVEL;
+
+  static Logger& get();
+
+  /**
+   * Starts the writer thread. Messages logged before are kept.
+   */
+  void start();
+
+  /**
+   * Writes out everything queued and stops the writer thread.
+   */
+  void stop();
+
+  /**
+   * Sets the runtime threshold; OFF silences everything.
+   */
+  void setLevel(LogLevel level) {
+    m_level.store(level, std::memory_order_relaxed);
+  }
+
+  bool enabled(LogLevel level) const {
+    return level >= COMPILED_LEVEL &&
+           level >= m_level.load(std::memory_order_relaxed);
+  }
+
+  template <LogLevel LEVEL, typename... Args>
+  void log(std::format_string<Args...> fmt, Args&&... args) {
+    if constexpr (LEVEL < COMPILED_LEVEL) {
+      return;
+    } else {
+      if (!enabled(LEVEL)) return;
+
+      Entry entry;
+      entry.time = std::chrono::system_clock::now();
+      if (!admit(fmt.get().data(), entry)) return;
+
+      entry.level = LEVEL;
+      auto result = std::format_to_n(
+          entry.text, sizeof(entry.text), fmt, std::forward<Args>(args)...);
+      entry.length =
+          (uint16_t)std::min<size_t>(result.size, sizeof(entry.text));
+      push(entry);
+    }
+  }
+
+ private:
+  Logger() = default;
+  ~Logger();
+
+  struct Entry {
+    std::chrono::system_clock::time_point time;
+    LogLevel level = LogLevel::INFO;
+    uint16_t length = 0;
+    uint32_t suppressed = 0;  // Rate-limited since the last one
+    char text[config::LOG_MESSAGE_BYTES];
+  };
+
+  struct RateSlot {
+    std::atomic<const char*> site{nullptr};
+    std::atomic<int64_t> second{0};
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint32_t> suppressed{0};
+  };
+
+  bool admit(const char* site, Entry& entry);
+  void push(const Entry& entry);
+  void raise(std::atomic<bool>& flag);
+  void run();
+  void drain();
+  void append(const Entry& entry);
+  void writeBatch();
+  bool openFile();
+
+  std::atomic<LogLevel> m_level{LogLevel::INFO};
+  MpscQueue<Entry, config::LOG_QUEUE_CAPACITY> m_queue;
+  std::atomic<uint64_t> m_dropped{0};
+  std::array<RateSlot, 64> m_rates;
+
+  std::mutex m_wakeMutex;
+  std::condition_variable m_wake;
+  std::atomic<bool> m_pending{false};  // Queued since the last drain
+  std::atomic<bool> m_urgent{false};   // Flush without waiting
+  bool m_stopping = false;
+  std::thread m_thread;
+
+  // Writer thread only
+  std::string m_batch;
+  int m_fd = -1;
+  size_t m_fileBytes = 0;
+};
+
+template <typename... Args>
+void logDebug(std::format_string<Args...> fmt, Args&&... args) {
+  Logger::get().log<LogLevel::DEBUG>(fmt, std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+void logInfo(std::format_string<Args...> fmt, Args&&... args) {
+  Logger::get().log<LogLevel::INFO>(fmt, std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+void logWarn(std::format_string<Args...> fmt, Args&&... args) {
+  Logger::get().log<LogLevel::WARN>(fmt, std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+void logError(std::format_string<Args...> fmt, Args&&... args) {
+  Logger::get().log<LogLevel::ERROR>(fmt, std::forward<Args>(args)...);
+}
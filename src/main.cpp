@@ -1,5 +1,10 @@
 #include "overlay-state.hpp"
 #include "decoration.hpp"
+#include "texture-cache.hpp"
+#include "settings.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "latency-tracer.hpp"
 #include <hyprland/src/plugins/PluginAPI.hpp>
 #include <hyprland/src/config/ConfigManager.hpp>
 #include <hyprland/src/render/Renderer.hpp>
@@ -10,11 +15,7 @@ HANDLE PHANDLE = nullptr;
 static void addDecoration(PHLWINDOW pWindow) {
   if (!pWindow) return;
 
-  if (OverlayState::get()) {
-    OverlayState::get()->log(
-        "Adding decoration to: " +
-        std::format("0x{:x}", (uintptr_t)pWindow.get()));
-  }
+  logDebug("Adding decoration to: 0x{:x}", (uintptr_t)pWindow.get());
 
   auto deco = makeUnique<Superglue>(pWindow);
   HyprlandAPI::addWindowDecoration(PHANDLE, pWindow, std::move(deco));
@@ -25,6 +26,196 @@ static void onNewWindow(void* self, std::any data) {
   addDecoration(pWindow);
 }
 
+static void applyConfig() {
+  auto changedIcons = settings::reload();
+  Logger::get().setLevel(settings::current().logLevel);
+  TextureCache::get().setBudget(settings::current().textureBudgetBytes);
+  TextureCache::get().setIconDir(settings::iconDir());
+  TextureCache::get().invalidate(changedIcons);
+  if (OverlayState::get()) OverlayState::get()->onConfigReloaded();
+}
+
+static std::string formatTextureStats(eHyprCtlOutputFormat format) {
+  TextureStats stats = TextureCache::get().stats();
+
+  if (format == eHyprCtlOutputFormat::FORMAT_JSON) {
+    return std::format(
+        "{{\"hits\": {}, \"misses\": {}, \"evictions\": {}, "
+        "\"decodes\": {}, \"decodeMs\": {:.2f}, \"residentBytes\": {}, "
+        "\"residentIcons\": {}, \"residentVariants\": {}, "
+        "\"budgetBytes\": {}}}",
+        stats.hits, stats.misses, stats.evictions, stats.decodes,
+        stats.decodeMs, stats.residentBytes, stats.residentIcons,
+        stats.residentVariants, stats.budgetBytes);
+  }
+
+  return std::format(
+      "textures: {} icons, {} prescaled, {} / {} KiB resident\n"
+      "hits: {}, misses: {}, evictions: {}\n"
+      "decodes: {}, {:.2f} ms total\n",
+      stats.residentIcons, stats.residentVariants,
+      stats.residentBytes / 1024, stats.budgetBytes / 1024, stats.hits,
+      stats.misses, stats.evictions, stats.decodes, stats.decodeMs);
+}
+
+// Names as used by the text protocol; internal ops get their own.
+static constexpr const char* COMMAND_NAMES[COMMAND_OP_COUNT] = {
+    "none", "vol-up", "vol-down", "vol-level", "scroll-start",
+    "scroll-stop", "mute-clear", "mute-add", "mute-remove", "repaint",
+    "reload-icons", "create", "update", "destroy",
+};
+
+static constexpr const char* HISTOGRAM_NAMES[] = {
+    "commandToDamageUs", "renderPassUs", "overlaysPerFrame", "damagePixels",
+};
+static_assert(std::size(HISTOGRAM_NAMES) == (size_t)Histogram::COUNT);
+
+static std::string formatStats(eHyprCtlOutputFormat format) {
+  auto& metrics = Metrics::get();
+  TextureStats textures = TextureCache::get().stats();
+  bool json = format == eHyprCtlOutputFormat::FORMAT_JSON;
+  std::string out =
+      json ? "{\"commands\": {" : "commands (received/rejected):\n";
+
+  bool first = true;
+  for (size_t i = 1; i < COMMAND_OP_COUNT; ++i) {
+    if (!isClientOp((CommandOp)i)) continue;
+    uint64_t received = metrics.received((CommandOp)i);
+    uint64_t rejected = metrics.rejected((CommandOp)i);
+    if (received == 0 && rejected == 0) continue;
+    if (json) {
+      out += std::format(
+          "{}\"{}\": {{\"received\": {}, \"rejected\": {}}}",
+          first ? "" : ", ", COMMAND_NAMES[i], received, rejected);
+    } else {
+      out += std::format(
+          "  {}: {}/{}\n", COMMAND_NAMES[i], received, rejected);
+    }
+    first = false;
+  }
+
+  out += json ? "}, \"histograms\": {" : "histograms:\n";
+  for (size_t i = 0; i < (size_t)Histogram::COUNT; ++i) {
+    auto h = metrics.histogram((Histogram)i);
+    if (json) {
+      out += std::format(
+          "{}\"{}\": {{\"count\": {}, \"mean\": {:.1f}, \"p50\": {}, "
+          "\"p90\": {}, \"p99\": {}, \"max\": {}}}",
+          i ? ", " : "", HISTOGRAM_NAMES[i], h.count, h.mean(),
+          h.percentile(0.5), h.percentile(0.9), h.percentile(0.99), h.max);
+    } else {
+      out += std::format(
+          "  {}: n={} mean={:.1f} p50<={} p90<={} p99<={} max={}\n",
+          HISTOGRAM_NAMES[i], h.count, h.mean(), h.percentile(0.5),
+          h.percentile(0.9), h.percentile(0.99), h.max);
+    }
+  }
+
+  uint64_t overlays = metrics.counter(Counter::OVERLAYS_DRAWN);
+  uint64_t dots = metrics.counter(Counter::TETHER_DOTS);
+  if (json) {
+    out += std::format(
+        "}}, \"overlaysDrawn\": {}, \"tetherDots\": {}, "
+        "\"textureHits\": {}, \"textureMisses\": {}",
+        overlays, dots, textures.hits, textures.misses);
+  } else {
+    out += std::format(
+        "overlays drawn: {}, tether dots: {}\n"
+        "texture hits: {}, misses: {}\n",
+        overlays, dots, textures.hits, textures.misses);
+  }
+
+  // Render pass CPU time per window and per monitor.
+  auto appendTimings = [&](const char* title, auto&& forEach) {
+    out += json ? std::format(", \"{}\": [", title)
+                : std::format("{}:\n", title);
+    bool firstTiming = true;
+    forEach([&](uint64_t key, const Metrics::Timing& timing) {
+      std::string name = timing.name.empty()
+          ? std::format("0x{:x}", key) : timing.name;
+      double meanUs = timing.passes ? timing.totalNs / 1e3 / timing.passes
+                                    : 0.0;
+      if (json) {
+        out += std::format(
+            "{}{{\"name\": \"{}\", \"passes\": {}, \"totalMs\": {:.2f}, "
+            "\"meanUs\": {:.1f}, \"maxUs\": {:.1f}}}",
+            firstTiming ? "" : ", ", name, timing.passes,
+            timing.totalNs / 1e6, meanUs, timing.maxNs / 1e3);
+      } else {
+        out += std::format(
+            "  {}: {} passes, {:.2f} ms total, {:.1f} us mean, "
+            "{:.1f} us max\n",
+            name, timing.passes, timing.totalNs / 1e6, meanUs,
+            timing.maxNs / 1e3);
+      }
+      firstTiming = false;
+    });
+    if (json) out += "]";
+  };
+  appendTimings("windows", [&](auto&& fn) {
+    metrics.forEachWindowTiming(fn);
+  });
+  appendTimings("monitors", [&](auto&& fn) {
+    metrics.forEachMonitorTiming(fn);
+  });
+
+  if (json) out += "}";
+  return out;
+}
+
+static constexpr const char* STAGE_NAMES[TRACE_STAGE_COUNT] = {
+    "sent", "read", "parsed", "applied", "damaged", "rendered",
+};
+
+static std::string formatLatency(eHyprCtlOutputFormat format) {
+  auto report = LatencyTracer::get().report();
+  bool json = format == eHyprCtlOutputFormat::FORMAT_JSON;
+
+  auto formatSpan = [json](const char* name, const LatencyTracer::Span& s) {
+    if (json) {
+      return std::format(
+          "\"{}\": {{\"count\": {}, \"p50Us\": {:.1f}, "
+          "\"p90Us\": {:.1f}, \"p99Us\": {:.1f}, \"maxUs\": {:.1f}}}",
+          name, s.count, s.p50Us, s.p90Us, s.p99Us, s.maxUs);
+    }
+    return std::format(
+        "  {:<18} n={} p50={:.1f} p90={:.1f} p99={:.1f} max={:.1f} us\n",
+        name, s.count, s.p50Us, s.p90Us, s.p99Us, s.maxUs);
+  };
+
+  std::string out = json
+      ? std::format("{{\"traces\": {}, \"slowestSeq\": {}, \"stages\": {{",
+                    report.traces, report.slowestSeq)
+      : std::format("{} traces, slowest seq {}\n", report.traces,
+                    report.slowestSeq);
+
+  // Each stage is timed from the one before it.
+  for (size_t i = 1; i < TRACE_STAGE_COUNT; ++i) {
+    std::string name =
+        std::format("{}->{}", STAGE_NAMES[i - 1], STAGE_NAMES[i]);
+    if (json && i > 1) out += ", ";
+    out += formatSpan(name.c_str(), report.stages[i]);
+  }
+  if (json) out += "}, ";
+  out += formatSpan("total", report.total);
+  if (json) out += "}";
+  return out;
+}
+
+static std::string onHyprCtl(eHyprCtlOutputFormat format, std::string request) {
+  // request is the full command line, e.g. "superglue textures".
+  if (request.find("textures") != std::string::npos) {
+    return formatTextureStats(format);
+  }
+  if (request.find("stats") != std::string::npos) {
+    return formatStats(format);
+  }
+  if (request.find("latency") != std::string::npos) {
+    return formatLatency(format);
+  }
+  return "usage: hyprctl superglue textures|stats|latency\n";
+}
+
 APICALL EXPORT std::string PLUGIN_API_VERSION() {
   return HYPRLAND_API_VERSION;
 }
@@ -35,8 +226,21 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
   try {
     fprintf(stderr, "[SUPERGLUE] Initializing...\n");
 
+    settings::registerValues();
+    Logger::get().start();
+
     g_pOverlayState = std::make_unique<OverlayState>();
     g_pOverlayState->init();
+    applyConfig();
+
+    static auto P3 = HyprlandAPI::registerCallbackDynamic(
+        PHANDLE, "configReloaded",
+        [&](void* self, SCallbackInfo& info, std::any data) {
+          applyConfig();
+        });
+
+    HyprlandAPI::registerHyprCtlCommand(
+        PHANDLE, SHyprCtlCommand{"superglue", false, onHyprCtl});
 
     static auto P = HyprlandAPI::registerCallbackDynamic(
         PHANDLE, "openWindow",
@@ -44,6 +248,21 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
           onNewWindow(self, data);
         });
 
+    // Sample the clock once per monitor frame; every decoration builds
+    // its overlay snapshot against this timestamp.
+    static auto P2 = HyprlandAPI::registerCallbackDynamic(
+        PHANDLE, "preRender",
+        [&](void* self, SCallbackInfo& info, std::any data) {
+          if (OverlayState::get()) OverlayState::get()->beginFrame();
+        });
+
+    // The tether tracks the cursor; damage it only when that moves.
+    static auto P4 = HyprlandAPI::registerCallbackDynamic(
+        PHANDLE, "mouseMove",
+        [&](void* self, SCallbackInfo& info, std::any data) {
+          if (OverlayState::get()) OverlayState::get()->onMouseMove();
+        });
+
     if (!g_pCompositor) {
       fprintf(stderr, "[SUPERGLUE] FATAL - g_pCompositor is null!\n");
       return {"Superglue", "Overlay decorations", "Snawy", "2.0"};
@@ -70,4 +289,5 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
 
 APICALL EXPORT void PLUGIN_EXIT() {
   g_pOverlayState.reset();
+  Logger::get().stop();
 }
@@ -0,0 +1,96 @@
+#include "metrics.hpp"
+#include <algorithm>
+
+// Bucket 0 holds zero; bucket i holds [2^(i-1), 2^i).
+static size_t bucketFor(uint64_t value) {
+  if (value == 0) return 0;
+  size_t bucket = 64 - __builtin_clzll(value);
+  return std::min(bucket, Metrics::BUCKETS - 1);
+}
+
+uint64_t Metrics::HistogramStats::percentile(double q) const {
+  if (count == 0) return 0;
+  uint64_t rank = (uint64_t)(q * (count - 1)) + 1;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      uint64_t upper = i == 0 ? 0 : (1ull << i) - 1;
+      return std::min(upper, max);
+    }
+  }
+  return max;
+}
+
+Metrics& Metrics::get() {
+  static Metrics instance;
+  return instance;
+}
+
+Metrics::Shard* Metrics::addShard() {
+  std::lock_guard<std::mutex> lock(m_shardsMutex);
+  m_shards.push_back(std::make_unique<Shard>());
+  return m_shards.back().get();
+}
+
+void Metrics::record(Histogram histogram, uint64_t value) {
+  auto& cells = shard().histograms[(size_t)histogram];
+  bump(cells.buckets[bucketFor(value)], 1);
+  bump(cells.sum, value);
+  if (value > cells.max.load(std::memory_order_relaxed)) {
+    cells.max.store(value, std::memory_order_relaxed);
+  }
+}
+
+uint64_t Metrics::sum(size_t counter) const {
+  std::lock_guard<std::mutex> lock(m_shardsMutex);
+  uint64_t total = 0;
+  for (const auto& shard : m_shards) {
+    total += shard->counters[counter].load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+Metrics::HistogramStats Metrics::histogram(Histogram histogram) const {
+  std::lock_guard<std::mutex> lock(m_shardsMutex);
+  HistogramStats stats;
+  for (const auto& shard : m_shards) {
+    const auto& cells = shard->histograms[(size_t)histogram];
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      uint64_t n = cells.buckets[i].load(std::memory_order_relaxed);
+      stats.buckets[i] += n;
+      stats.count += n;
+    }
+    stats.sum += cells.sum.load(std::memory_order_relaxed);
+    stats.max = std::max(stats.max, cells.max.load(std::memory_order_relaxed));
+  }
+  return stats;
+}
+
+void Metrics::recordRenderPass(
+    uint64_t window,
+    uint64_t monitor,
+    const std::string& monitorName,
+    uint64_t ns,
+    uint32_t overlays) {
+  record(Histogram::RENDER_PASS_US, ns / 1000);
+  add(Counter::OVERLAYS_DRAWN, overlays);
+  m_frameOverlays += overlays;
+
+  auto accumulate = [ns](Timing& timing) {
+    ++timing.passes;
+    timing.totalNs += ns;
+    timing.maxNs = std::max(timing.maxNs, ns);
+  };
+  accumulate(m_windowTimings[window]);
+
+  Timing& perMonitor = m_monitorTimings[monitor];
+  if (perMonitor.name != monitorName) perMonitor.name = monitorName;
+  accumulate(perMonitor);
+}
+
+void Metrics::endFrame() {
+  if (m_frameOverlays == 0) return;
+  record(Histogram::OVERLAYS_PER_FRAME, m_frameOverlays);
+  m_frameOverlays = 0;
+}
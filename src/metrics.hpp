@@ -0,0 +1,177 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "command.hpp"
+#include "flat-map.hpp"
+
+/**
+ * Event counts kept alongside the per-command ones.
+ */
+enum class Counter : uint8_t {
+  OVERLAYS_DRAWN,  // Icons, primitives and tethers
+  TETHER_DOTS,
+  COUNT,
+};
+
+/**
+ * Distributions, kept as power-of-two buckets.
+ */
+enum class Histogram : uint8_t {
+  COMMAND_TO_DAMAGE_US,  // Command received until its windows are damaged
+  RENDER_PASS_US,        // CPU time of one decoration render pass
+  OVERLAYS_PER_FRAME,    // Frames that drew nothing are not recorded
+  DAMAGE_PIXELS,         // Area of one damage submission
+  COUNT,
+};
+
+/**
+ * Runtime counters and histograms for `hyprctl superglue stats`.
+ *
+ * Every thread that records gets its own shard, which only that
+ * thread writes, so recording is a relaxed load and store with no
+ * locked instruction and no shared cache line. Reads sum the shards
+ * and may lag a recording thread by a few events.
+ *
+ * Render pass timings per window and per monitor are only touched by
+ * the compositor main thread, which also serves hyprctl.
+ */
+class Metrics {
+ public:
+  static constexpr size_t BUCKETS = 40;
+
+  struct HistogramStats {
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    std::array<uint64_t, BUCKETS> buckets{};
+
+    double mean() const { return count ? (double)sum / count : 0.0; }
+
+    /**
+     * Upper bound of the bucket holding quantile q, capped at max.
+     */
+    uint64_t percentile(double q) const;
+  };
+
+  struct Timing {
+    std::string name;  // Monitor name; empty for windows
+    uint64_t passes = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+  };
+
+  static Metrics& get();
+
+  void add(Counter counter, uint64_t n = 1) {
+    bump(shard().counters[(size_t)counter], n);
+  }
+
+  void commandReceived(CommandOp op) {
+    bump(shard().counters[RECEIVED + (size_t)op], 1);
+  }
+
+  void commandRejected(CommandOp op) {
+    bump(shard().counters[REJECTED + (size_t)op], 1);
+  }
+
+  void record(Histogram histogram, uint64_t value);
+
+  uint64_t counter(Counter counter) const {
+    return sum((size_t)counter);
+  }
+
+  uint64_t received(CommandOp op) const {
+    return sum(RECEIVED + (size_t)op);
+  }
+
+  uint64_t rejected(CommandOp op) const {
+    return sum(REJECTED + (size_t)op);
+  }
+
+  HistogramStats histogram(Histogram histogram) const;
+
+  /**
+   * Records one render pass of a window on a monitor. Main thread.
+   */
+  void recordRenderPass(
+      uint64_t window,
+      uint64_t monitor,
+      const std::string& monitorName,
+      uint64_t ns,
+      uint32_t overlays);
+
+  /**
+   * Closes the frame being rendered, recording how many overlays it
+   * drew. Main thread.
+   */
+  void endFrame();
+
+  /**
+   * Drops the render timing of a closed window. Main thread.
+   */
+  void forgetWindow(uint64_t window) { m_windowTimings.erase(window); }
+
+  /**
+   * Calls fn(window, timing) for each window drawn so far.
+   */
+  template <typename Fn>
+  void forEachWindowTiming(Fn&& fn) {
+    m_windowTimings.forEach(std::forward<Fn>(fn));
+  }
+
+  /**
+   * Calls fn(monitor, timing) for each monitor drawn on so far.
+   */
+  template <typename Fn>
+  void forEachMonitorTiming(Fn&& fn) {
+    m_monitorTimings.forEach(std::forward<Fn>(fn));
+  }
+
+ private:
+  static constexpr size_t RECEIVED = (size_t)Counter::COUNT;
+  static constexpr size_t REJECTED = RECEIVED + COMMAND_OP_COUNT;
+  static constexpr size_t COUNTERS = REJECTED + COMMAND_OP_COUNT;
+
+  struct HistogramCells {
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+  };
+
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, COUNTERS> counters{};
+    std::array<HistogramCells, (size_t)Histogram::COUNT> histograms;
+  };
+
+  Metrics() = default;
+
+  Shard& shard() {
+    thread_local Shard* local = nullptr;
+    if (!local) local = addShard();
+    return *local;
+  }
+
+  // Only the owning thread writes a shard, so no read-modify-write.
+  static void bump(std::atomic<uint64_t>& cell, uint64_t n) {
+    cell.store(cell.load(std::memory_order_relaxed) + n,
+               std::memory_order_relaxed);
+  }
+
+  Shard* addShard();
+  uint64_t sum(size_t counter) const;
+
+  // Shards outlive their threads so their counts keep adding up.
+  mutable std::mutex m_shardsMutex;
+  std::vector<std::unique_ptr<Shard>> m_shards;
+
+  // Main thread only
+  FlatMap<uint64_t, Timing> m_windowTimings;
+  FlatMap<uint64_t, Timing> m_monitorTimings;
+  uint64_t m_frameOverlays = 0;
+};
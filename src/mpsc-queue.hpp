@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Bounded lock-free multi-producer single-consumer queue.
+ * Each cell carries a sequence number so producers claim slots
+ * with one CAS and never block; push() fails when full.
+ */
+template <typename T, size_t Capacity>
+class MpscQueue {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of two");
+
+ public:
+  MpscQueue() {
+    for (size_t i = 0; i < Capacity; ++i) {
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  /**
+   * Enqueues a value from any thread. Returns false when full.
+   */
+  bool push(const T& value) {
+    Cell* cell;
+    size_t pos = m_head.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &m_cells[pos & (Capacity - 1)];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+      if (diff == 0) {
+        if (m_head.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = m_head.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->value = value;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Dequeues a value. Must only be called from the consumer thread.
+   */
+  bool pop(T& out) {
+    Cell& cell = m_cells[m_tail & (Capacity - 1)];
+    size_t seq = cell.sequence.load(std::memory_order_acquire);
+    if ((intptr_t)seq - (intptr_t)(m_tail + 1) < 0) return false;
+
+    out = cell.value;
+    cell.sequence.store(m_tail + Capacity, std::memory_order_release);
+    ++m_tail;
+    return true;
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  std::array<Cell, Capacity> m_cells;
+  alignas(64) std::atomic<size_t> m_head{0};
+  alignas(64) size_t m_tail = 0;
+};
@@ -0,0 +1,469 @@
+#include "overlay-model.hpp"
+#include "settings.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Whether value can be stored in a field holding a uint32_t.
+static bool fitsUint32(double value) {
+  return value >= 0 && value <= std::numeric_limits<uint32_t>::max();
+}
+
+OverlayModel::OverlayModel(const Clock& clock, WakeFn wakeAt, LogFn log)
+    : m_clock(clock), m_wakeAt(std::move(wakeAt)), m_log(std::move(log)) {
+  // Enough for a full command queue; handles keep the index in their
+  // low 16 bits.
+  static_assert(config::COMMAND_QUEUE_CAPACITY <= 0x10000);
+  m_texts.resize(config::COMMAND_QUEUE_CAPACITY);
+  m_freeTexts.reserve(m_texts.size());
+  for (size_t i = m_texts.size(); i > 0; --i) m_freeTexts.push_back(i - 1);
+}
+
+void OverlayModel::apply(const OverlayCommand& command) {
+  if (command.op == CommandOp::MUTE_CLEAR) {
+    m_mutedWindows.forEach([this](WindowHandle window, bool) {
+      markDirty(window);
+    });
+    m_mutedWindows.clear();
+    return;
+  }
+
+  if (command.op == CommandOp::PRIM_CREATE ||
+      command.op == CommandOp::PRIM_SET ||
+      command.op == CommandOp::PRIM_DESTROY) {
+    applyPrimitive(command, m_clock.now());
+    return;
+  }
+
+  WindowHandle window = command.window;
+  if (window == 0) return;
+
+  switch (command.op) {
+    case CommandOp::SCROLL_START: {
+      OverlayEvent event;
+      event.type = OverlayType::SCROLL_ANCHOR;
+      event.x = command.x;
+      event.y = command.y;
+      m_scrollAnchors[window] = event;
+      break;
+    }
+
+    case CommandOp::SCROLL_STOP:
+      m_scrollAnchors.erase(window);
+      break;
+
+    case CommandOp::VOLUME_UP:
+    case CommandOp::VOLUME_DOWN:
+    case CommandOp::VOLUME_LEVEL:
+      applyVolume(command, m_clock.now());
+      break;
+
+    case CommandOp::MUTE_ADD:
+      m_mutedWindows.insert(window);
+      break;
+
+    case CommandOp::MUTE_REMOVE:
+      m_mutedWindows.erase(window);
+      break;
+
+    default:
+      return;
+  }
+
+  markDirty(window);
+}
+
+void OverlayModel::applyVolume(const OverlayCommand& command, TimePoint now) {
+  auto& events = m_volumeEvents[command.window];
+
+  // Clear previous events for this address to avoid stacking
+  events.clear();
+
+  // Create volume level event (shows in center)
+  OverlayEvent levelEvent;
+  levelEvent.type = OverlayType::VOLUME_LEVEL;
+  levelEvent.startTime = now;
+  levelEvent.volumeLevel = command.level;
+  events.push_back(levelEvent);
+
+  // Create direction arrow event
+  if (command.op != CommandOp::VOLUME_LEVEL) {
+    OverlayEvent arrowEvent;
+    arrowEvent.type = command.op == CommandOp::VOLUME_UP
+        ? OverlayType::VOLUME_UP
+        : OverlayType::VOLUME_DOWN;
+    arrowEvent.startTime = now;
+    arrowEvent.volumeLevel = command.level;
+    events.push_back(arrowEvent);
+  }
+
+  // Nothing changes on screen until the first fade starts.
+  if (m_wakeAt) {
+    for (const auto& event : events) {
+      m_wakeAt(now + std::chrono::milliseconds(
+                         settings::forType(event.type).displayMs));
+    }
+  }
+}
+
+void OverlayModel::applyPrimitive(
+    const OverlayCommand& command,
+    TimePoint now) {
+  if (command.level <= 0) return;
+  uint32_t id = command.level;
+
+  switch (command.op) {
+    case CommandOp::PRIM_CREATE: {
+      auto kind = (PrimitiveKind)command.flags;
+      if (command.window == 0 || kind > PrimitiveKind::PROGRESS) return;
+      // Creating an existing id replaces it.
+      destroyPrimitive(id);
+
+      auto handle = m_primitives.create();
+      if (!handle) {
+        if (m_log) {
+          m_log("Primitive pool full, dropping " + std::to_string(id));
+        }
+        return;
+      }
+      Primitive& primitive = *m_primitives.get(handle);
+      primitive.kind = kind;
+      primitive.id = command.level;
+      primitive.window = command.window;
+
+      m_primitiveIds[id] = handle;
+      m_windowPrimitives[command.window].push_back(handle);
+      markDirty(command.window);
+      break;
+    }
+
+    case CommandOp::PRIM_SET: {
+      auto* handle = m_primitiveIds.find(id);
+      Primitive* primitive = handle ? m_primitives.get(*handle) : nullptr;
+      if (!primitive) {
+        releaseText(command);
+        return;
+      }
+      if (!setPrimitiveField(
+              *primitive, (PrimitiveField)command.flags, command.x, now)) {
+        if (m_log) {
+          m_log("Bad value for primitive " + std::to_string(id) +
+                " field " + std::to_string(command.flags));
+        }
+        return;
+      }
+      markDirty(primitive->window);
+      break;
+    }
+
+    case CommandOp::PRIM_DESTROY:
+      destroyPrimitive(id);
+      break;
+
+    default:
+      break;
+  }
+}
+
+bool OverlayModel::setPrimitiveField(
+    Primitive& primitive,
+    PrimitiveField field,
+    double value,
+    TimePoint now) {
+  // Ring records skip the parser, so a value is checked against what
+  // its field can hold before it is converted.
+  if (!std::isfinite(value) ||
+      std::abs(value) > std::numeric_limits<float>::max()) {
+    return false;
+  }
+
+  switch (field) {
+    case PrimitiveField::X: primitive.x = value; break;
+    case PrimitiveField::Y: primitive.y = value; break;
+    case PrimitiveField::W: primitive.w = std::max(0.0, value); break;
+    case PrimitiveField::H: primitive.h = std::max(0.0, value); break;
+    case PrimitiveField::X2: primitive.x2 = value; break;
+    case PrimitiveField::Y2: primitive.y2 = value; break;
+    case PrimitiveField::COLOR:
+      if (!fitsUint32(value)) return false;
+      primitive.color = (uint32_t)value;
+      break;
+    case PrimitiveField::ALPHA:
+      primitive.alpha = std::clamp(value, 0.0, 1.0);
+      break;
+    case PrimitiveField::RADIUS: primitive.radius = value; break;
+    case PrimitiveField::THICKNESS:
+      primitive.thickness = std::max(0.0, value);
+      break;
+    case PrimitiveField::ICON:
+      if (!iconFromValue(value, primitive.icon)) return false;
+      break;
+    case PrimitiveField::TEXT: {
+      auto text = takeText(value);
+      if (!text) return false;
+      primitive.text = std::move(*text);
+      break;
+    }
+    case PrimitiveField::SIZE:
+      primitive.size = std::max(0.0, value);
+      break;
+    case PrimitiveField::RING: primitive.ring = std::max(0.0, value); break;
+    case PrimitiveField::VALUE:
+      primitive.value = std::clamp(value, 0.0, 1.0);
+      break;
+    case PrimitiveField::BACKGROUND:
+      if (!fitsUint32(value)) return false;
+      primitive.background = (uint32_t)value;
+      break;
+    case PrimitiveField::TTL:
+      if (value <= 0) {
+        primitive.expires = Primitive::TimePoint::max();
+        break;
+      }
+      if (value > std::numeric_limits<int32_t>::max()) return false;
+      primitive.expires = now + std::chrono::milliseconds((int64_t)value);
+      if (m_wakeAt) m_wakeAt(primitive.expires);
+      break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+WindowHandle OverlayModel::targetWindow(const OverlayCommand& command) const {
+  if (command.op != CommandOp::PRIM_SET &&
+      command.op != CommandOp::PRIM_DESTROY) {
+    return command.window;
+  }
+  if (command.level <= 0) return 0;
+  auto* handle = m_primitiveIds.find((uint32_t)command.level);
+  const Primitive* primitive = handle ? m_primitives.get(*handle) : nullptr;
+  return primitive ? primitive->window : 0;
+}
+
+void OverlayModel::destroyPrimitive(uint32_t id) {
+  auto* handle = m_primitiveIds.find(id);
+  if (!handle) return;
+
+  PrimitiveHandle removed = *handle;
+  m_primitiveIds.erase(id);
+  Primitive* primitive = m_primitives.get(removed);
+  if (!primitive) return;
+
+  // Keep creation order, which is also draw order.
+  WindowHandle window = primitive->window;
+  if (auto* handles = m_windowPrimitives.find(window)) {
+    handles->erase(
+        std::remove(handles->begin(), handles->end(), removed),
+        handles->end());
+    if (handles->empty()) m_windowPrimitives.erase(window);
+  }
+  m_primitives.destroy(removed);
+  markDirty(window);
+}
+
+void OverlayModel::removeWindow(WindowHandle window) {
+  // Primitives belong to the window; drop them with it.
+  if (auto* handles = m_windowPrimitives.find(window)) {
+    std::vector<PrimitiveHandle> owned = *handles;
+    for (auto handle : owned) {
+      if (auto* primitive = m_primitives.get(handle)) {
+        destroyPrimitive(primitive->id);
+      }
+    }
+  }
+
+  // A new window may reuse the address; it must not inherit anything.
+  m_volumeEvents.erase(window);
+  m_scrollAnchors.erase(window);
+  m_mutedWindows.erase(window);
+  m_dirtyWindows.erase(window);
+}
+
+std::optional<uint32_t> OverlayModel::storeText(std::string text) {
+  std::lock_guard<std::mutex> lock(m_textMutex);
+  if (m_freeTexts.empty()) return std::nullopt;
+
+  uint32_t index = m_freeTexts.back();
+  m_freeTexts.pop_back();
+  TextSlot& slot = m_texts[index];
+  slot.text = std::move(text);
+  slot.used = true;
+  ++slot.generation;
+  return ((uint32_t)slot.generation << 16) | index;
+}
+
+void OverlayModel::releaseText(const OverlayCommand& command) {
+  if (command.op == CommandOp::PRIM_SET &&
+      command.flags == (uint16_t)PrimitiveField::TEXT) {
+    takeText(command.x);
+  }
+}
+
+std::optional<std::string> OverlayModel::takeText(double handle) {
+  if (!fitsUint32(handle)) return std::nullopt;
+  uint32_t index = (uint32_t)handle & 0xffff;
+  uint32_t generation = (uint32_t)handle >> 16;
+
+  std::lock_guard<std::mutex> lock(m_textMutex);
+  if (index >= m_texts.size()) return std::nullopt;
+  TextSlot& slot = m_texts[index];
+  if (!slot.used || slot.generation != generation) return std::nullopt;
+
+  slot.used = false;
+  m_freeTexts.push_back(index);
+  return std::move(slot.text);
+}
+
+std::optional<OverlayModel::TimePoint> OverlayModel::tick(
+    std::chrono::steady_clock::duration frameInterval) {
+  auto now = m_clock.now();
+  std::optional<TimePoint> next;
+
+  auto wakeAt = [&next](TimePoint when) {
+    if (!next || when < *next) next = when;
+  };
+
+  m_volumeEvents.forEach(
+      [&](WindowHandle window, std::vector<OverlayEvent>& events) {
+        for (auto it = events.begin(); it != events.end();) {
+          const auto& cfg = settings::forType(it->type);
+          auto fadeStart =
+              it->startTime + std::chrono::milliseconds(cfg.displayMs);
+          auto fadeEnd = fadeStart + std::chrono::milliseconds(cfg.fadeMs);
+          if (now < fadeStart) {
+            wakeAt(fadeStart);
+          } else if (now < fadeEnd) {
+            // Fading: repaint at the display rate until it is over.
+            markDirty(window);
+            wakeAt(now + frameInterval);
+          } else {
+            // Done. Dropped here rather than by the next snapshot, as
+            // a window that isn't drawn would otherwise be repainted
+            // on every tick; one last repaint clears it.
+            it = events.erase(it);
+            markDirty(window);
+            continue;
+          }
+          ++it;
+        }
+      });
+
+  m_primitives.forEach([&](PrimitiveHandle, Primitive& primitive) {
+    if (primitive.expires <= now) {
+      destroyPrimitive(primitive.id);
+    } else if (primitive.expires != Primitive::TimePoint::max()) {
+      wakeAt(primitive.expires);
+    }
+  });
+
+  return next;
+}
+
+void OverlayModel::markAllVisibleDirty() {
+  markAnchorsDirty();
+  m_volumeEvents.forEach(
+      [this](WindowHandle window, std::vector<OverlayEvent>& events) {
+        if (!events.empty()) markDirty(window);
+      });
+  m_mutedWindows.forEach([this](WindowHandle window, bool) {
+    markDirty(window);
+  });
+  m_windowPrimitives.forEach(
+      [this](WindowHandle window, std::vector<PrimitiveHandle>& handles) {
+        if (!handles.empty()) markDirty(window);
+      });
+}
+
+void OverlayModel::markAnchorsDirty() {
+  m_scrollAnchors.forEach([this](WindowHandle window, OverlayEvent&) {
+    markDirty(window);
+  });
+}
+
+float OverlayModel::opacity(const OverlayEvent& event, TimePoint now) {
+  if (event.type == OverlayType::SCROLL_ANCHOR) return 1.0f;
+
+  const auto& cfg = settings::forType(event.type);
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      now - event.startTime).count();
+
+  if (elapsed < cfg.displayMs) {
+    return 1.0f;
+  }
+
+  int fadeEnd = cfg.displayMs + cfg.fadeMs;
+  if (elapsed < fadeEnd) {
+    return 1.0f - (float)(elapsed - cfg.displayMs) / cfg.fadeMs;
+  }
+  return 0.0f;
+}
+
+void OverlayModel::buildSnapshot(
+    WindowHandle window,
+    TimePoint now,
+    OverlaySnapshot& snapshot) {
+  snapshot.clear();
+  snapshot.time = now;
+
+  appendScrollInfo(window, snapshot);
+  appendVolumeInfo(window, snapshot);
+  appendMuteInfo(window, snapshot);
+}
+
+void OverlayModel::appendScrollInfo(
+    WindowHandle window,
+    OverlaySnapshot& snapshot) {
+  if (auto* found = m_scrollAnchors.find(window)) {
+    auto& anchor = *found;
+    OverlayInfo info;
+    info.type = OverlayType::SCROLL_ANCHOR;
+    info.opacity = 1.0f;
+    info.icon = settings::forType(OverlayType::SCROLL_ANCHOR).icon;
+    info.hasCustomPos = true;
+    info.x = anchor.x;
+    info.y = anchor.y;
+    snapshot.push(info);
+  }
+}
+
+void OverlayModel::appendVolumeInfo(
+    WindowHandle window,
+    OverlaySnapshot& snapshot) {
+  if (auto* found = m_volumeEvents.find(window)) {
+    auto& events = *found;
+    for (auto it = events.begin(); it != events.end();) {
+      float eventOpacity = opacity(*it, snapshot.time);
+      if (eventOpacity <= 0.0f) {
+        it = events.erase(it);
+      } else {
+        OverlayInfo info;
+        info.type = it->type;
+        info.opacity = eventOpacity;
+        info.volumeLevel = it->volumeLevel;
+
+        // Use volume level icon for VOLUME_LEVEL type
+        if (it->type == OverlayType::VOLUME_LEVEL) {
+          info.icon = config::getVolumeLevelIcon(it->volumeLevel);
+        } else {
+          info.icon = settings::forType(it->type).icon;
+        }
+
+        snapshot.push(info);
+        ++it;
+      }
+    }
+  }
+}
+
+void OverlayModel::appendMuteInfo(
+    WindowHandle window,
+    OverlaySnapshot& snapshot) {
+  if (m_mutedWindows.contains(window)) {
+    OverlayInfo info;
+    info.type = OverlayType::MUTE;
+    info.opacity = 1.0f;
+    info.icon = settings::forType(OverlayType::MUTE).icon;
+    snapshot.push(info);
+  }
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include "types.hpp"
+#include "clock.hpp"
+#include "config.hpp"
+#include "command.hpp"
+#include "flat-map.hpp"
+#include "slot-pool.hpp"
+#include "primitive.hpp"
+
+/**
+ * Overlay state for all windows, free of compositor plumbing.
+ *
+ * Holds volume events, scroll anchors, mutes and client-created
+ * primitives, and does the fade and expiry math. Commands and ticks
+ * take the time from the injected clock; windows whose overlays
+ * changed collect in a dirty set for the owner to damage, and the
+ * next time anything changes on its own is reported through the wake
+ * callback.
+ *
+ * Main thread only, except storeText() and releaseText().
+ */
+class OverlayModel {
+ public:
+  using TimePoint = Clock::TimePoint;
+  using WakeFn = std::function<void(TimePoint)>;
+  using LogFn = std::function<void(const std::string&)>;
+
+  OverlayModel(const Clock& clock, WakeFn wakeAt, LogFn log);
+
+  /**
+   * Applies one command as of the clock's now.
+   */
+  void apply(const OverlayCommand& command);
+
+  /**
+   * Fills snapshot with the overlays visible on a window at now.
+   * Expired events are dropped as a side effect.
+   */
+  void buildSnapshot(
+      WindowHandle window,
+      TimePoint now,
+      OverlaySnapshot& snapshot);
+
+  /**
+   * Opacity of an event at now: 1 while displayed, then a linear
+   * fade to 0.
+   */
+  static float opacity(const OverlayEvent& event, TimePoint now);
+
+  /**
+   * Marks windows that are fading now dirty and drops expired
+   * primitives. Returns when the next tick is due, if ever; while a
+   * fade runs that is one frameInterval away.
+   */
+  std::optional<TimePoint> tick(
+      std::chrono::steady_clock::duration frameInterval);
+
+  /**
+   * Forgets everything about a window that went away.
+   */
+  void removeWindow(WindowHandle window);
+
+  /**
+   * Parks a label string for a PRIM_SET TEXT command and returns the
+   * handle the command carries, or nothing when every slot is taken.
+   * The slot stays reserved until the command is applied. Safe from
+   * any thread.
+   */
+  std::optional<uint32_t> storeText(std::string text);
+
+  /**
+   * Frees the label of a PRIM_SET TEXT command that will never be
+   * applied; other commands are ignored. Safe from any thread.
+   */
+  void releaseText(const OverlayCommand& command);
+
+  /**
+   * Returns the window command would change, or 0 if none: its own
+   * window, or for primitive updates the window the primitive is on.
+   * Call before applying it.
+   */
+  WindowHandle targetWindow(const OverlayCommand& command) const;
+
+  void markDirty(WindowHandle window) { m_dirtyWindows.insert(window); }
+  void markAllVisibleDirty();
+  void markAnchorsDirty();
+
+  /**
+   * Windows changed since the owner last cleared the set.
+   */
+  FlatSet<WindowHandle>& dirtyWindows() { return m_dirtyWindows; }
+
+  bool hasPrimitives(WindowHandle window) const {
+    auto* handles = m_windowPrimitives.find(window);
+    return handles && !handles->empty();
+  }
+
+  /**
+   * Calls fn(primitive) for each primitive on a window still alive
+   * at now, in creation order.
+   */
+  template <typename Fn>
+  void forEachPrimitive(WindowHandle window, TimePoint now, Fn&& fn) {
+    auto* handles = m_windowPrimitives.find(window);
+    if (!handles) return;
+    for (auto handle : *handles) {
+      const Primitive* primitive = m_primitives.get(handle);
+      if (primitive && primitive->expires > now) fn(*primitive);
+    }
+  }
+
+ private:
+  using PrimitiveHandle = SlotPool<Primitive>::Handle;
+
+  void applyVolume(const OverlayCommand& command, TimePoint now);
+  void applyPrimitive(const OverlayCommand& command, TimePoint now);
+  bool setPrimitiveField(
+      Primitive& primitive,
+      PrimitiveField field,
+      double value,
+      TimePoint now);
+  void destroyPrimitive(uint32_t id);
+  std::optional<std::string> takeText(double handle);
+
+  void appendScrollInfo(WindowHandle window, OverlaySnapshot& snapshot);
+  void appendVolumeInfo(WindowHandle window, OverlaySnapshot& snapshot);
+  void appendMuteInfo(WindowHandle window, OverlaySnapshot& snapshot);
+
+  const Clock& m_clock;
+  WakeFn m_wakeAt;
+  LogFn m_log;
+
+  FlatMap<WindowHandle, std::vector<OverlayEvent>> m_volumeEvents;
+  FlatMap<WindowHandle, OverlayEvent> m_scrollAnchors;
+  FlatSet<WindowHandle> m_mutedWindows;
+  FlatSet<WindowHandle> m_dirtyWindows;
+
+  SlotPool<Primitive> m_primitives{config::MAX_PRIMITIVES};
+  FlatMap<uint32_t, PrimitiveHandle> m_primitiveIds;  // Client id
+  FlatMap<WindowHandle, std::vector<PrimitiveHandle>> m_windowPrimitives;
+
+  // Strings for PRIM_SET TEXT, whose record only has room for a
+  // number. A slot is held from storeText() until its command is
+  // applied or released, so a queued label is never overwritten; the
+  // generation in a handle's high bits makes stale handles miss.
+  struct TextSlot {
+    std::string text;
+    uint16_t generation = 0;
+    bool used = false;
+  };
+
+  std::mutex m_textMutex;
+  std::vector<TextSlot> m_texts;
+  std::vector<uint32_t> m_freeTexts;
+};
@@ -1,10 +1,22 @@
 #include "overlay-state.hpp"
 #include "file-watcher.hpp"
+#include "ipc-server.hpp"
 #include "decoration.hpp"
+#include "texture-cache.hpp"
+#include "text-cache.hpp"
+#include "animation-clock.hpp"
+#include "settings.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "latency-tracer.hpp"
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <format>
 #include <unistd.h>
+#include <sys/eventfd.h>
 #include <hyprland/src/Compositor.hpp>
+#include <hyprland/src/render/OpenGL.hpp>
 
 std::unique_ptr<OverlayState> g_pOverlayState;
 
@@ -16,25 +28,42 @@ static int handleEvent(int fd, uint32_t mask, void* data) {
   return ((OverlayState*)data)->onEvent(fd, mask);
 }
 
-OverlayState::OverlayState() {
-  log("OverlayState constructor");
-  if (pipe(m_eventFd) != 0) {
-    log("Failed to create pipe!");
+OverlayState::OverlayState()
+    : m_model(
+          m_clock,
+          [this](std::chrono::steady_clock::time_point when) {
+            if (m_animationClock) m_animationClock->wakeAt(when);
+          },
+          [](const std::string& msg) { logWarn("{}", msg); }),
+      m_parser({
+          [](std::string_view name) {
+            return TextureCache::get().intern(std::string(name));
+          },
+          [this](std::string text) {
+            return m_model.storeText(std::move(text));
+          },
+          [](const std::string& msg) { logWarn("{}", msg); },
+      }) {
+  logDebug("OverlayState constructor");
+  m_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_eventFd < 0) {
+    logError("Failed to create eventfd!");
   }
   initFileWatcher();
 }
 
 OverlayState::~OverlayState() {
-  log("OverlayState destructor");
+  logDebug("OverlayState destructor");
+  TextureCache::get().setReadyCallback(nullptr);
   shutdown();
+  m_ipc.reset();
+  m_animationClock.reset();
   if (m_eventSource) wl_event_source_remove(m_eventSource);
-  close(m_eventFd[0]);
-  close(m_eventFd[1]);
+  if (m_eventFd >= 0) close(m_eventFd);
 }
 
 void OverlayState::initFileWatcher() {
-  m_watcher = std::make_unique<FileWatcher>(
-      config::DEFAULT_POLL_INTERVAL_MS);
+  m_watcher = std::make_unique<FileWatcher>();
 
   m_watcher->watch(
       config::MUTE_STATE_FILE,
@@ -47,6 +76,29 @@ void OverlayState::initFileWatcher() {
       [this](const std::string& content) {
         onOverlayCommand(content);
       });
+
+  watchIconDir(settings::iconDir());
+}
+
+void OverlayState::watchIconDir(const std::string& dir) {
+  // Edits in a directory no longer configured must not reload icons.
+  m_watcher->unwatchDirectory(m_iconDirWatch);
+  m_watchedIconDir = dir;
+  m_iconDirWatch = m_watcher->watchDirectory(
+      dir,
+      [this, dir](const std::vector<std::string>& names) {
+        onIconsChanged(dir, names);
+      });
+}
+
+void OverlayState::onConfigReloaded() {
+  if (settings::iconDir() != m_watchedIconDir) {
+    watchIconDir(settings::iconDir());
+  }
+
+  // Positions and timings may have changed for what is on screen.
+  m_model.markAllVisibleDirty();
+  flushDamage();
 }
 
 void OverlayState::init() {
@@ -54,268 +106,318 @@ void OverlayState::init() {
     wl_event_loop* loop =
         wl_display_get_event_loop(g_pCompositor->m_wlDisplay);
     m_eventSource = wl_event_loop_add_fd(
-        loop, m_eventFd[0], WL_EVENT_READABLE, handleEvent, this);
-    log("Event loop hook registered.");
+        loop, m_eventFd, WL_EVENT_READABLE, handleEvent, this);
+    logInfo("Event loop hook registered.");
+
+    m_animationClock = std::make_unique<AnimationClock>(
+        loop, [this]() { onAnimationTick(); });
+
+    // Decoders run off-thread; have them wake us so windows showing
+    // a not-yet-drawable icon get repainted once it is.
+    TextureCache::get().setReadyCallback([this]() {
+      OverlayCommand repaint;
+      repaint.op = CommandOp::REPAINT;
+      submitCommand(repaint);
+      signalMainThread();
+    });
+    // Mute and anchor icons stay up for as long as their state
+    // lasts, so keep them out of eviction; decode the icon set now
+    // rather than on the first keypress.
+    for (IconId icon : {IconId::MUTE, IconId::ANCHOR, IconId::ANCHOR_UP,
+                        IconId::ANCHOR_DOWN}) {
+      TextureCache::get().setPinned(icon, true);
+    }
+    TextureCache::get().prefetch(IconId::MUTE);
+
+    m_ipc = std::make_unique<IpcServer>(
+        [this](std::string_view content) { onSocketCommands(content); },
+        [this](const OverlayCommand& command) { onRingCommand(command); },
+        [this]() { onSocketBatchEnd(); });
+    std::string socketPath = config::getSocketPath();
+    if (m_ipc->start(loop, socketPath)) {
+      logInfo("Listening for commands on {}", socketPath);
+    } else {
+      logError("Failed to listen on {}", socketPath);
+    }
   } else {
-    log("FATAL: Compositor not available during init!");
+    logError("FATAL: Compositor not available during init!");
   }
 }
 
 int OverlayState::onEvent(int fd, uint32_t mask) {
   if (mask & WL_EVENT_READABLE) {
-    char buf[8];
-    read(fd, buf, sizeof(buf));
-
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    for (auto* win : m_windows) {
-      if (win) win->damageEntire();
+    // One read resets the eventfd counter, however many signals were
+    // coalesced into it; then apply everything queued so far.
+    uint64_t count;
+    read(fd, &count, sizeof(count));
+
+    QueuedCommand queued;
+    while (m_queue.pop(queued)) {
+      applyCommand(queued.command, queued.trace);
     }
+    flushCommandDamage();
   }
   return 0;
 }
 
-void OverlayState::dispatchDamage() {
-  char c = 1;
-  if (write(m_eventFd[1], &c, 1) < 0) {
-    log("Failed to write to pipe!");
+void OverlayState::flushDamage() {
+  auto& dirty = m_model.dirtyWindows();
+  dirty.forEach([this](WindowHandle window, bool) {
+    if (auto* win = m_windows.find(window)) (*win)->damageEntire();
+    if (auto* trace = m_windowTraces.find(window)) {
+      LatencyTracer::get().mark(*trace, TraceStage::DAMAGED);
+    }
+  });
+  dirty.clear();
+}
+
+void OverlayState::markReceived() {
+  // Only the first command of a batch is timed; the load keeps the
+  // rest from contending on the CAS.
+  if (m_receivedNs.load(std::memory_order_relaxed) != 0) return;
+  int64_t expected = 0;
+  m_receivedNs.compare_exchange_strong(
+      expected, m_clock.now().time_since_epoch().count(),
+      std::memory_order_relaxed);
+}
+
+void OverlayState::flushCommandDamage() {
+  bool damaged = !m_model.dirtyWindows().empty();
+  flushDamage();
+
+  int64_t received = m_receivedNs.exchange(0, std::memory_order_relaxed);
+  if (damaged && received != 0) {
+    auto elapsed = m_clock.now().time_since_epoch() -
+        std::chrono::steady_clock::duration(received);
+    Metrics::get().record(
+        Histogram::COMMAND_TO_DAMAGE_US,
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+            .count());
   }
 }
 
-void OverlayState::shutdown() {
-  if (m_watcher) m_watcher->stop();
+void OverlayState::onAnimationTick() {
+  auto next = m_model.tick(frameInterval());
+  flushDamage();
+  if (next) m_animationClock->wakeAt(*next);
 }
 
-void OverlayState::log(const std::string& msg) {
-  static std::recursive_mutex logMutex;
-  std::lock_guard<std::recursive_mutex> lock(logMutex);
-  std::ofstream f(config::LOG_FILE, std::ios::app);
-  f << msg << std::endl;
+std::chrono::steady_clock::duration OverlayState::frameInterval() {
+  // Tick as fast as the fastest monitor so no fade frame is skipped.
+  float refreshRate = 0.0f;
+  if (g_pCompositor) {
+    for (const auto& monitor : g_pCompositor->m_monitors) {
+      refreshRate = std::max(refreshRate, monitor->m_refreshRate);
+    }
+  }
+  if (refreshRate <= 0.0f) refreshRate = 60.0f;
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<float>(1.0f / refreshRate));
+}
+
+void OverlayState::submitCommand(
+    const OverlayCommand& command,
+    TraceId trace) {
+  if (!m_queue.push({command, trace})) {
+    logWarn("Command queue full, dropping command");
+    m_model.releaseText(command);
+  }
+}
+
+void OverlayState::signalMainThread() {
+  uint64_t one = 1;
+  if (write(m_eventFd, &one, sizeof(one)) < 0) {
+    logError("Failed to signal eventfd!");
+  }
+}
+
+void OverlayState::shutdown() {
+  if (m_watcher) m_watcher->stop();
 }
 
 void OverlayState::registerWindow(Superglue* win) {
-  log("Registering window: " + win->getWindowAddress());
-  std::lock_guard<std::recursive_mutex> lock(m_mutex);
-  m_windows.insert(win);
+  logDebug("Registering window: 0x{:x}", win->getWindowHandle());
+  m_windows[win->getWindowHandle()] = win;
 }
 
 void OverlayState::unregisterWindow(Superglue* win) {
-  std::lock_guard<std::recursive_mutex> lock(m_mutex);
-  m_windows.erase(win);
+  auto* registered = m_windows.find(win->getWindowHandle());
+  if (registered && *registered == win) {
+    m_windows.erase(win->getWindowHandle());
+    m_model.removeWindow(win->getWindowHandle());
+    m_windowTraces.erase(win->getWindowHandle());
+    Metrics::get().forgetWindow(win->getWindowHandle());
+  }
 }
 
 void OverlayState::onMuteStateChanged(const std::string& content) {
-  std::unordered_set<std::string> newAddresses;
+  // The file lists every muted window, so replace the set wholesale.
+  OverlayCommand clear;
+  clear.op = CommandOp::MUTE_CLEAR;
+  submitCommand(clear);
+
   std::istringstream stream(content);
   std::string line;
-
   while (std::getline(stream, line)) {
-    if (!line.empty()) newAddresses.insert(line);
-  }
+    if (line.empty()) continue;
 
-  {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    m_mutedAddresses = newAddresses;
+    OverlayCommand command;
+    command.op = CommandOp::MUTE_ADD;
+    command.window = CommandParser::parseAddress(line);
+    submitCommand(command);
   }
-  dispatchDamage();
+  signalMainThread();
 }
 
 void OverlayState::onOverlayCommand(const std::string& content) {
   if (content.empty()) return;
 
-  std::istringstream stream(content);
-  std::string line;
-  bool damageNeeded = false;
-
-  while (std::getline(stream, line)) {
-    if (line.empty()) continue;
-
-    std::istringstream lineStream(line);
-    std::string cmd;
-    lineStream >> cmd;
-
-    if (cmd == "scroll-start" || cmd == "scroll-stop") {
-      // Put cmd back into stream or pass it? 
-      // Actually simpler to pass cmd string and let handler parse rest
-      // My helper declaration takes lineStream. 
-      // Need to handle "scroll-stop" logic. 
-      
-      // Re-parsing approach inside loop:
-      if (cmd == "scroll-start") {
-          handleScrollCommand(lineStream, damageNeeded);
-      } else if (cmd == "scroll-stop") {
-          std::string addr;
-          if (lineStream >> addr) {
-             log("Scroll Stop: " + addr);
-             std::lock_guard<std::recursive_mutex> lock(m_mutex);
-             m_scrollAnchors.erase(addr);
-             damageNeeded = true;
-          }
-      } else {
-          handleVolumeCommand(lineStream, cmd, damageNeeded);
-      }
-    } else {
-        handleVolumeCommand(lineStream, cmd, damageNeeded);
-    }
-  }
+  // Runs on the watcher thread: hand parsed commands to the main
+  // thread, which owns all overlay state.
+  m_parser.parse(
+      content, [this](const OverlayCommand& command, TraceId trace) {
+        markReceived();
+        submitCommand(command, trace);
+      });
 
   // Clear the command file
   std::ofstream clear(config::OVERLAY_CMD_FILE, std::ios::trunc);
 
-  if (damageNeeded) dispatchDamage();
+  signalMainThread();
 }
 
-void OverlayState::handleScrollCommand(
-    std::istringstream& lineStream,
-    bool& damageNeeded) {
-  std::string addr;
-  double x, y;
-  if (lineStream >> addr >> x >> y) {
-    auto logMsg = "Scroll Start: " + addr + " at " +
-                  std::to_string(x) + "," + std::to_string(y);
-    log(logMsg);
-
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    OverlayEvent event;
-    event.type = OverlayType::SCROLL_ANCHOR;
-    event.x = x;
-    event.y = y;
-    m_scrollAnchors[addr] = event;
-    damageNeeded = true;
+void OverlayState::onIconsChanged(
+    const std::string& dir,
+    const std::vector<std::string>& names) {
+  // Runs on the watcher thread; decoding is kicked off from the main
+  // thread, which owns the texture cache.
+  std::vector<std::string> paths;
+  for (const auto& name : names) {
+    paths.push_back(dir + "/" + name);
   }
-}
-
-void OverlayState::handleVolumeCommand(
-    std::istringstream& lineStream,
-    const std::string& cmd,
-    bool& damageNeeded) {
-  std::string addr;
-  int volume = 0;
-  if (lineStream >> addr >> volume) {
-    if (addr.empty()) return;
-
-    auto logMsg = "Received cmd: " + cmd + " for " + addr +
-                  " vol: " + std::to_string(volume);
-    log(logMsg);
-
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-
-    // Clear previous events for this address to avoid stacking
-    m_volumeEvents[addr].clear();
-
-    auto now = std::chrono::steady_clock::now();
-
-    // Create volume level event (shows in center)
-    OverlayEvent levelEvent;
-    levelEvent.type = OverlayType::VOLUME_LEVEL;
-    levelEvent.startTime = now;
-    levelEvent.volumeLevel = volume;
-    m_volumeEvents[addr].push_back(levelEvent);
-
-    // Create direction arrow event
-    OverlayEvent arrowEvent;
-    arrowEvent.startTime = now;
-    arrowEvent.volumeLevel = volume;
-    if (cmd == "vol-up") {
-      arrowEvent.type = OverlayType::VOLUME_UP;
-    } else if (cmd == "vol-down") {
-      arrowEvent.type = OverlayType::VOLUME_DOWN;
-    }
+  TextureCache::get().markStale(paths);
 
-    if (arrowEvent.type != OverlayType::NONE) {
-      m_volumeEvents[addr].push_back(arrowEvent);
-    }
-
-    damageNeeded = true;
-  }
+  OverlayCommand reload;
+  reload.op = CommandOp::RELOAD_ICONS;
+  submitCommand(reload);
+  signalMainThread();
 }
 
+void OverlayState::onSocketCommands(std::string_view content) {
+  // Socket clients are serviced on the main thread, so commands are
+  // applied as they are parsed without going through the queue.
+  m_parser.parse(
+      content, [this](const OverlayCommand& command, TraceId trace) {
+        markReceived();
+        applyCommand(command, trace);
+      });
+}
 
-float OverlayState::calculateOpacity(const OverlayEvent& event) {
-  if (event.type == OverlayType::SCROLL_ANCHOR) return 1.0f;
+void OverlayState::onRingCommand(const OverlayCommand& command) {
+  markReceived();
+  applyCommand(command);
+}
 
-  auto now = std::chrono::steady_clock::now();
-  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-      now - event.startTime).count();
+void OverlayState::onSocketBatchEnd() {
+  flushCommandDamage();
+}
 
-  if (elapsed < config::DEFAULT_DISPLAY_MS) {
-    return 1.0f;
+void OverlayState::applyCommand(
+    const OverlayCommand& command,
+    TraceId trace) {
+  // Internal ops (repaints, reloads, the mute file) aren't client
+  // traffic.
+  if (isClientOp(command.op)) Metrics::get().commandReceived(command.op);
+
+  if (command.op == CommandOp::REPAINT) {
+    // Upload now so the damage below is sized by the new icons;
+    // a pending icon contributes nothing to a window's region.
+    g_pHyprOpenGL->makeEGLCurrent();
+    TextureCache::get().uploadPending();
+    m_model.markAllVisibleDirty();
+    return;
   }
 
-  int fadeEnd = config::DEFAULT_DISPLAY_MS + config::DEFAULT_FADE_MS;
-  if (elapsed < fadeEnd) {
-    return 1.0f - (float)(elapsed - config::DEFAULT_DISPLAY_MS) /
-        config::DEFAULT_FADE_MS;
+  if (command.op == CommandOp::RELOAD_ICONS) {
+    // Windows are repainted through REPAINT once the new pixels land.
+    TextureCache::get().reloadStale();
+    return;
   }
-  return 0.0f;
-}
 
-std::vector<OverlayInfo> OverlayState::getOverlayInfo(
-    const std::string& address) {
-  std::lock_guard<std::recursive_mutex> lock(m_mutex);
-  std::vector<OverlayInfo> result;
+  prefetchIcons(command);
+  // Primitive updates name no window, so look it up before a destroy
+  // forgets it.
+  WindowHandle window = trace ? m_model.targetWindow(command) : 0;
+  m_model.apply(command);
+  if (trace) attachTrace(trace, window);
+}
 
-  appendScrollInfo(address, result);
-  appendVolumeInfo(address, result);
-  appendMuteInfo(address, result);
+void OverlayState::attachTrace(TraceId trace, WindowHandle window) {
+  LatencyTracer::get().mark(trace, TraceStage::APPLIED);
 
-  return result;
+  // Only the window this command changed; others in the dirty set
+  // were changed by earlier commands of the batch. A window keeps the
+  // oldest trace until it is drawn.
+  if (window == 0 || !m_model.dirtyWindows().contains(window)) return;
+  if (!m_windowTraces.contains(window)) m_windowTraces[window] = trace;
 }
 
-void OverlayState::appendScrollInfo(
-    const std::string& address,
-    std::vector<OverlayInfo>& result) {
-  if (m_scrollAnchors.contains(address)) {
-    auto& anchor = m_scrollAnchors[address];
-    OverlayInfo info;
-    info.type = OverlayType::SCROLL_ANCHOR;
-    info.opacity = 1.0f;
-    info.iconPath = config::getDefaultIconPath(
-        OverlayType::SCROLL_ANCHOR);
-    info.hasCustomPos = true;
-    info.x = anchor.x;
-    info.y = anchor.y;
-    result.push_back(info);
-  }
+TraceId OverlayState::takeTrace(WindowHandle window) {
+  auto* trace = m_windowTraces.find(window);
+  if (!trace) return 0;
+  TraceId id = *trace;
+  m_windowTraces.erase(window);
+  return id;
 }
 
-void OverlayState::appendVolumeInfo(
-    const std::string& address,
-    std::vector<OverlayInfo>& result) {
-  if (m_volumeEvents.contains(address)) {
-    auto& events = m_volumeEvents[address];
-    for (auto it = events.begin(); it != events.end();) {
-      float opacity = calculateOpacity(*it);
-      if (opacity <= 0.0f) {
-        it = events.erase(it);
-      } else {
-        OverlayInfo info;
-        info.type = it->type;
-        info.opacity = opacity;
-        info.volumeLevel = it->volumeLevel;
-
-        // Use volume level icon for VOLUME_LEVEL type
-        if (it->type == OverlayType::VOLUME_LEVEL) {
-          info.iconPath = config::getVolumeLevelIconPath(
-              it->volumeLevel);
-        } else {
-          info.iconPath = config::getDefaultIconPath(it->type);
-        }
-
-        result.push_back(info);
-        ++it;
+void OverlayState::prefetchIcons(const OverlayCommand& command) {
+  // Warm the icons the next command is likely to need: adjacent
+  // volume levels, the anchor variants the tether switches between
+  // while scrolling, and icons handed to primitives.
+  auto& cache = TextureCache::get();
+  switch (command.op) {
+    case CommandOp::SCROLL_START:
+      cache.prefetch(IconId::ANCHOR);
+      cache.prefetch(IconId::ANCHOR_UP);
+      cache.prefetch(IconId::ANCHOR_DOWN);
+      break;
+
+    case CommandOp::VOLUME_UP:
+    case CommandOp::VOLUME_DOWN:
+    case CommandOp::VOLUME_LEVEL: {
+      int current = (int)config::getVolumeLevelIcon(command.level);
+      int first = (int)IconId::VOLUME_0;
+      int last = first + config::VOLUME_LEVEL_ICONS - 1;
+      for (int icon = current - 1; icon <= current + 1; ++icon) {
+        if (icon >= first && icon <= last) cache.prefetch((IconId)icon);
+      }
+      cache.prefetch(IconId::VOLUME_UP);
+      cache.prefetch(IconId::VOLUME_DOWN);
+      break;
+    }
+
+    case CommandOp::PRIM_SET: {
+      IconId icon;
+      if (command.flags == (uint16_t)PrimitiveField::ICON &&
+          iconFromValue(command.x, icon)) {
+        cache.prefetch(icon);
       }
+      break;
     }
+
+    default:
+      break;
   }
 }
 
-void OverlayState::appendMuteInfo(
-    const std::string& address,
-    std::vector<OverlayInfo>& result) {
-  if (m_mutedAddresses.contains(address)) {
-    OverlayInfo info;
-    info.type = OverlayType::MUTE;
-    info.opacity = 1.0f;
-    info.iconPath = config::getDefaultIconPath(OverlayType::MUTE);
-    result.push_back(info);
-  }
+void OverlayState::onMouseMove() {
+  m_model.markAnchorsDirty();
+  flushDamage();
+}
+
+void OverlayState::beginFrame() {
+  Metrics::get().endFrame();
+  m_frameTime = m_clock.now();
+  TextureCache::get().beginFrame();
+  TextCache::get().beginFrame();
 }
@@ -1,20 +1,38 @@
 #pragma once
 
 #include <string>
-#include <unordered_set>
-#include <unordered_map>
-#include <mutex>
+#include <vector>
 #include <memory>
+#include <functional>
+#include <string_view>
+#include <atomic>
 #include <wayland-server.h>
 #include "types.hpp"
 #include "config.hpp"
+#include "command.hpp"
+#include "mpsc-queue.hpp"
+#include "flat-map.hpp"
+#include "command-parser.hpp"
+#include "overlay-model.hpp"
+#include "latency-tracer.hpp"
 
 class Superglue;
 class FileWatcher;
+class IpcServer;
+class AnimationClock;
 
 /**
- * Manages overlay state for all windows.
- * Tracks muted windows and transient volume events.
+ * Connects the overlay model to the compositor: command sources,
+ * damage, timers and the texture cache. The state itself lives in
+ * OverlayModel.
+ *
+ * All state is owned by the compositor main thread. The file
+ * watcher thread only parses commands and hands them over through
+ * a lock-free queue, waking the main thread with an eventfd.
+ *
+ * Fades are driven by an event loop timer armed for the next
+ * visual change, so windows are only repainted while an overlay is
+ * actually changing.
  */
 class OverlayState {
  public:
@@ -24,9 +42,69 @@ class OverlayState {
   static OverlayState* get();
 
   /**
-   * Gets overlay info for a window by address.
+   * Fills snapshot with the overlays visible on a window at now.
+   * Expired events are dropped as a side effect.
    */
-  std::vector<OverlayInfo> getOverlayInfo(const std::string& address);
+  void buildSnapshot(
+      WindowHandle window,
+      std::chrono::steady_clock::time_point now,
+      OverlaySnapshot& snapshot) {
+    m_model.buildSnapshot(window, now, snapshot);
+  }
+
+  /**
+   * Returns whether a window has any client-created primitives.
+   */
+  bool hasPrimitives(WindowHandle window) const {
+    return m_model.hasPrimitives(window);
+  }
+
+  /**
+   * Calls fn(primitive) for each primitive on a window still alive
+   * at now, in creation order.
+   */
+  template <typename Fn>
+  void forEachPrimitive(
+      WindowHandle window,
+      std::chrono::steady_clock::time_point now,
+      Fn&& fn) {
+    m_model.forEachPrimitive(window, now, std::forward<Fn>(fn));
+  }
+
+  /**
+   * Samples the clock once for the frame about to be rendered.
+   */
+  void beginFrame();
+
+  /**
+   * Applies settings changed by a config reload to what is on screen.
+   */
+  void onConfigReloaded();
+
+  /**
+   * Repaints windows whose tether follows the cursor.
+   */
+  void onMouseMove();
+
+  /**
+   * Returns the current time on the clock driving the overlays.
+   */
+  std::chrono::steady_clock::time_point now() const {
+    return m_clock.now();
+  }
+
+  /**
+   * Returns the timestamp sampled by the last beginFrame().
+   */
+  std::chrono::steady_clock::time_point frameTime() const {
+    return m_frameTime;
+  }
+
+  /**
+   * Returns the trace of the oldest traced command waiting to be
+   * drawn on a window, handing it over to the caller, or 0.
+   */
+  TraceId takeTrace(WindowHandle window);
 
   /**
    * Registers a window decoration for damage updates.
@@ -38,11 +116,6 @@ class OverlayState {
    */
   void unregisterWindow(Superglue* win);
 
-  /**
-   * Logs a message to the log file.
-   */
-  void log(const std::string& msg);
-
   /**
    * Stops background processing.
    */
@@ -54,7 +127,7 @@ class OverlayState {
   void init();
 
   /**
-   * Handles events from the pipe.
+   * Applies queued commands after the eventfd fired.
    */
   int onEvent(int fd, uint32_t mask);
 
@@ -62,40 +135,57 @@ class OverlayState {
   void initFileWatcher();
   void onMuteStateChanged(const std::string& content);
   void onOverlayCommand(const std::string& content);
-  
-  // Helper methods for command parsing
-  void handleScrollCommand(
-      std::istringstream& lineStream,
-      bool& damageNeeded);
-  void handleVolumeCommand(
-      std::istringstream& lineStream,
-      const std::string& cmd,
-      bool& damageNeeded);
-
-  // Helper methods for overlay info
-  void appendScrollInfo(
-      const std::string& address,
-      std::vector<OverlayInfo>& result);
-  void appendVolumeInfo(
-      const std::string& address,
-      std::vector<OverlayInfo>& result);
-  void appendMuteInfo(
-      const std::string& address,
-      std::vector<OverlayInfo>& result);
-
-  void dispatchDamage();
-  float calculateOpacity(const OverlayEvent& event);
-
-  std::unordered_map<std::string, std::vector<OverlayEvent>>
-      m_volumeEvents;
-  std::unordered_map<std::string, OverlayEvent> m_scrollAnchors;
-  std::unordered_set<std::string> m_mutedAddresses;
-  std::unordered_set<Superglue*> m_windows;
+  void watchIconDir(const std::string& dir);
+  void onIconsChanged(
+      const std::string& dir,
+      const std::vector<std::string>& names);
+  void onSocketCommands(std::string_view content);
+  void onRingCommand(const OverlayCommand& command);
+  void onSocketBatchEnd();
+  void applyCommand(const OverlayCommand& command, TraceId trace = 0);
+  void attachTrace(TraceId trace, WindowHandle window);
+  void prefetchIcons(const OverlayCommand& command);
+
+  void submitCommand(const OverlayCommand& command, TraceId trace = 0);
+  void signalMainThread();
+  void flushDamage();
 
-  std::unique_ptr<FileWatcher> m_watcher;
-  std::recursive_mutex m_mutex;
+  /**
+   * Notes that a client command arrived, for the command-to-damage
+   * latency. Internal wakeups don't call it. Safe from any thread.
+   */
+  void markReceived();
+
+  /**
+   * Flushes damage after a batch of commands and records how long
+   * the batch took to reach the screen.
+   */
+  void flushCommandDamage();
+  void onAnimationTick();
+  std::chrono::steady_clock::duration frameInterval();
 
-  int m_eventFd[2];
+  const Clock& m_clock = Clock::steady();
+  OverlayModel m_model;
+  CommandParser m_parser;
+  FlatMap<WindowHandle, Superglue*> m_windows;
+  FlatMap<WindowHandle, TraceId> m_windowTraces;
+  std::chrono::steady_clock::time_point m_frameTime;
+
+  std::unique_ptr<FileWatcher> m_watcher;
+  std::string m_watchedIconDir;
+  int m_iconDirWatch = -1;
+  std::unique_ptr<IpcServer> m_ipc;
+  std::unique_ptr<AnimationClock> m_animationClock;
+
+  // Commands crossing from the watcher thread, with their trace.
+  struct QueuedCommand {
+    OverlayCommand command;
+    TraceId trace = 0;
+  };
+
+  MpscQueue<QueuedCommand, config::COMMAND_QUEUE_CAPACITY> m_queue;
+  std::atomic<int64_t> m_receivedNs{0};  // Oldest unflushed command
+  int m_eventFd = -1;
   wl_event_source* m_eventSource = nullptr;
 };
 
@@ -9,6 +9,7 @@ void GluePassElement::draw(const CRegion& damage) {
   m_data.deco->renderPass(
       g_pHyprOpenGL->m_renderData.pMonitor.lock(),
       m_data.a);
+  LatencyTracer::get().mark(m_data.trace, TraceStage::RENDERED);
 }
 
 bool GluePassElement::needsLiveBlur() {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <hyprland/src/render/pass/PassElement.hpp>
+#include "latency-tracer.hpp"
 
 class Superglue;
 
@@ -12,6 +13,7 @@ class GluePassElement : public IPassElement {
   struct SGlueData {
     Superglue* deco = nullptr;
     float a = 1.0f;
+    TraceId trace = 0;  // Traced command this pass first shows
   };
 
   explicit GluePassElement(const SGlueData& data);
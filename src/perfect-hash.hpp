@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Compile-time lookup tables for small fixed sets of names.
+ *
+ * Each name is placed at its hash modulo SIZE when the table is
+ * built. A collision is not a constant expression, so a table that
+ * is not perfect fails to compile; grow SIZE or change HASH_SEED.
+ * A lookup is one hash and one compare.
+ */
+namespace perfect_hash {
+
+constexpr uint32_t HASH_SEED = 2;
+
+constexpr uint32_t hash(std::string_view name) {
+  uint32_t h = 2166136261u ^ HASH_SEED;  // FNV-1a
+  for (char c : name) {
+    h ^= (uint8_t)c;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+template <typename Value, size_t SIZE>
+class Table {
+ public:
+  struct Entry {
+    std::string_view name;
+    Value value{};
+  };
+
+  template <size_t N>
+  constexpr Table(const Entry (&entries)[N]) {
+    static_assert(N <= SIZE);
+    for (const auto& entry : entries) {
+      auto& slot = m_slots[hash(entry.name) % SIZE];
+      if (!slot.name.empty()) throw "perfect_hash::Table: names collide";
+      slot = entry;
+    }
+  }
+
+  /**
+   * Returns the value for name, or nullptr if it is not in the table.
+   */
+  constexpr const Value* find(std::string_view name) const {
+    const auto& slot = m_slots[hash(name) % SIZE];
+    return !name.empty() && slot.name == name ? &slot.value : nullptr;
+  }
+
+ private:
+  std::array<Entry, SIZE> m_slots{};
+};
+
+}  // namespace perfect_hash
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "types.hpp"
+#include "config.hpp"
+#include "perfect-hash.hpp"
+
+/**
+ * Kind of a client-created overlay primitive.
+ * Values travel in OverlayCommand::flags; only append.
+ */
+enum class PrimitiveKind : uint16_t {
+  ICON = 0,
+  RECT = 1,
+  LINE = 2,
+  TEXT = 3,
+  CIRCLE = 4,
+  PROGRESS = 5,
+};
+
+/**
+ * Settable primitive property, one per PRIM_SET command.
+ * Values travel in OverlayCommand::flags; only append.
+ */
+enum class PrimitiveField : uint16_t {
+  X = 0,
+  Y = 1,
+  W = 2,
+  H = 3,
+  X2 = 4,
+  Y2 = 5,
+  COLOR = 6,      // 0xRRGGBBAA
+  ALPHA = 7,
+  RADIUS = 8,
+  THICKNESS = 9,
+  TTL = 10,       // Milliseconds from now; 0 lives until destroyed
+  ICON = 11,      // IconId
+  TEXT = 12,      // Handle of a string handed over separately
+  SIZE = 13,      // Font size in pixels; 0 uses the configured size
+  RING = 14,      // Outline width for rects and circles; 0 fills
+  VALUE = 15,     // Progress fraction 0..1
+  BACKGROUND = 16,  // Progress track, 0xRRGGBBAA
+  COUNT
+};
+
+/**
+ * A client-addressed overlay element attached to one window.
+ * Coordinates are logical pixels relative to the window's top-left
+ * corner. Lives in a SlotPool and is updated in place.
+ */
+struct Primitive {
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  PrimitiveKind kind = PrimitiveKind::RECT;
+  int32_t id = 0;
+  WindowHandle window = 0;
+  float x = 0, y = 0;    // Box origin, line start or circle centre
+  float w = 0, h = 0;    // Box size; 0 for icons means native size
+  float x2 = 0, y2 = 0;  // Line end
+  uint32_t color = 0xffffffff;
+  float alpha = 1.0f;
+  float radius = 0;      // Corner radius, or circle radius
+  float thickness = 2.0f;
+  float ring = 0;
+  float value = 0;
+  uint32_t background = 0x00000066;
+  IconId icon = IconId::NONE;
+  std::string text;
+  float size = 0;
+  TimePoint expires = TimePoint::max();
+};
+
+/**
+ * Parses a primitive property name. Returns COUNT if unknown.
+ */
+inline PrimitiveField parsePrimitiveField(std::string_view name) {
+  using F = PrimitiveField;
+  static constexpr perfect_hash::Table<F, 64> FIELDS({
+      {"x", F::X}, {"y", F::Y}, {"w", F::W}, {"h", F::H},
+      {"x2", F::X2}, {"y2", F::Y2}, {"color", F::COLOR},
+      {"alpha", F::ALPHA}, {"radius", F::RADIUS},
+      {"thickness", F::THICKNESS}, {"ttl", F::TTL}, {"icon", F::ICON},
+      {"text", F::TEXT}, {"size", F::SIZE}, {"ring", F::RING},
+      {"value", F::VALUE}, {"background", F::BACKGROUND},
+  });
+  auto* field = FIELDS.find(name);
+  return field ? *field : F::COUNT;
+}
+
+/**
+ * Converts an ICON field value to an icon id, returning false for
+ * values no icon can have. Ids past the ones interned so far are
+ * caught by the texture cache.
+ */
+inline bool iconFromValue(double value, IconId& icon) {
+  constexpr double LIMIT =
+      (double)IconId::COUNT + (double)config::MAX_DYNAMIC_ICONS;
+  if (!(value >= 0 && value < LIMIT)) return false;
+  icon = (IconId)(uint16_t)value;
+  return true;
+}
@@ -0,0 +1,36 @@
+#include "render-utils.hpp"
+
+namespace render {
+
+GLuint compileProgram(const char* vertexSrc, const char* fragmentSrc) {
+  return g_pHyprOpenGL->createProgram(vertexSrc, fragmentSrc, true, true);
+}
+
+std::array<float, 9> pixelProjection() {
+  // Same composition Hyprland uses for its own quads, minus the
+  // per-box transform: vertices are already in monitor pixels.
+  auto& data = g_pHyprOpenGL->m_renderData;
+  return data.projection.copy().multiply(data.monitorProjection).getMatrix();
+}
+
+SP<CTexture> createTexture(int w, int h, const void* data, GLint filter) {
+  SP<CTexture> tex = makeShared<CTexture>();
+  tex->allocate();
+  glBindTexture(GL_TEXTURE_2D, tex->m_texID);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+#ifndef GLES2
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+#endif
+
+  glTexImage2D(
+      GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0,
+      GL_RGBA, GL_UNSIGNED_BYTE, data);
+  return tex;
+}
+
+}  // namespace render
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <hyprland/src/render/OpenGL.hpp>
+#include <array>
+
+/**
+ * Small helpers shared by the plugin's own GL draw paths.
+ * Everything here must run on the render thread inside a pass.
+ */
+namespace render {
+
+/**
+ * Compiles and links a shader program. Returns 0 on failure.
+ */
+GLuint compileProgram(const char* vertexSrc, const char* fragmentSrc);
+
+/**
+ * Matrix mapping monitor-local pixel coordinates to clip space
+ * for the monitor currently being rendered (row-major, 3x3).
+ */
+std::array<float, 9> pixelProjection();
+
+/**
+ * Uploads tightly packed premultiplied ARGB pixels (cairo's layout)
+ * into a new texture sampled with filter.
+ */
+SP<CTexture> createTexture(int w, int h, const void* data, GLint filter);
+
+/**
+ * Runs draw once per rectangle of the current render damage with the
+ * scissor set to it, then clears the scissor.
+ */
+template <typename Fn>
+void forEachDamageRect(Fn&& draw) {
+  for (auto const& rect : g_pHyprOpenGL->m_renderData.damage.getRects()) {
+    g_pHyprOpenGL->scissor(&rect);
+    draw();
+  }
+  g_pHyprOpenGL->scissor(nullptr);
+}
+
+}  // namespace render
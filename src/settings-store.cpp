@@ -0,0 +1,66 @@
+#include "settings.hpp"
+#include "config.hpp"
+
+namespace settings {
+
+void resolveIcons(Table& table, OverlayType type, const std::string& base) {
+  std::string prefix = table.iconDir + "/" + base;
+  switch (type) {
+    case OverlayType::VOLUME_UP:
+      table.iconPaths[(size_t)IconId::VOLUME_UP] = prefix + ".png";
+      break;
+    case OverlayType::VOLUME_DOWN:
+      table.iconPaths[(size_t)IconId::VOLUME_DOWN] = prefix + ".png";
+      break;
+    case OverlayType::MUTE:
+      table.iconPaths[(size_t)IconId::MUTE] = prefix + ".png";
+      break;
+    case OverlayType::SCROLL_ANCHOR:
+      table.iconPaths[(size_t)IconId::ANCHOR] = prefix + ".png";
+      table.iconPaths[(size_t)IconId::ANCHOR_UP] = prefix + "_up.png";
+      table.iconPaths[(size_t)IconId::ANCHOR_DOWN] = prefix + "_down.png";
+      break;
+    case OverlayType::VOLUME_LEVEL:
+      for (int i = 0; i < config::VOLUME_LEVEL_ICONS; ++i) {
+        table.iconPaths[(size_t)IconId::VOLUME_0 + i] =
+            prefix + std::to_string(i) + ".png";
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+Table defaults(const std::string& iconDir) {
+  Table table;
+  table.iconDir = iconDir;
+  table.textureBudgetBytes = (size_t)config::DEFAULT_TEXTURE_BUDGET_KB * 1024;
+  table.font = config::DEFAULT_FONT;
+  table.fontSize = config::DEFAULT_FONT_SIZE;
+  for (size_t i = 0; i < OVERLAY_TYPE_COUNT; ++i) {
+    auto type = (OverlayType)i;
+    table.types[i] = config::getDefaultConfig(type);
+    resolveIcons(table, type, config::getDefaultIconName(type));
+  }
+  return table;
+}
+
+static Table s_table = defaults(config::getIconDir());
+
+const Table& current() {
+  return s_table;
+}
+
+std::vector<IconId> install(Table table) {
+  std::vector<IconId> changed;
+  for (size_t i = 0; i < table.iconPaths.size(); ++i) {
+    if (table.iconPaths[i] != s_table.iconPaths[i]) {
+      changed.push_back((IconId)i);
+    }
+  }
+
+  s_table = std::move(table);
+  return changed;
+}
+
+}  // namespace settings
@@ -0,0 +1,116 @@
+#include "settings.hpp"
+#include "config.hpp"
+#include <algorithm>
+#include <hyprland/src/plugins/PluginAPI.hpp>
+
+extern HANDLE PHANDLE;
+
+namespace settings {
+
+// Config key prefix per overlay type, e.g. plugin:superglue:mute:position.
+static const char* typeKey(OverlayType type) {
+  switch (type) {
+    case OverlayType::MUTE: return "mute";
+    case OverlayType::VOLUME_UP: return "volume_up";
+    case OverlayType::VOLUME_DOWN: return "volume_down";
+    case OverlayType::VOLUME_LEVEL: return "volume_level";
+    case OverlayType::SCROLL_ANCHOR: return "anchor";
+    default: return nullptr;
+  }
+}
+
+static std::string key(const std::string& name) {
+  return "plugin:superglue:" + name;
+}
+
+static Hyprlang::INT readInt(const std::string& name) {
+  auto* value = HyprlandAPI::getConfigValue(PHANDLE, key(name));
+  return value ? **(Hyprlang::INT* const*)value->getDataStaticPtr() : 0;
+}
+
+static std::string readString(const std::string& name) {
+  auto* value = HyprlandAPI::getConfigValue(PHANDLE, key(name));
+  if (!value) return "";
+  Hyprlang::STRING str = *(Hyprlang::STRING const*)value->getDataStaticPtr();
+  return str ? str : "";
+}
+
+void registerValues() {
+  auto addInt = [](const std::string& name, Hyprlang::INT value) {
+    HyprlandAPI::addConfigValue(PHANDLE, key(name), Hyprlang::INT{value});
+  };
+  auto addString = [](const std::string& name, const char* value) {
+    HyprlandAPI::addConfigValue(
+        PHANDLE, key(name), Hyprlang::STRING{value});
+  };
+
+  addInt("display_ms", config::DEFAULT_DISPLAY_MS);
+  addInt("fade_ms", config::DEFAULT_FADE_MS);
+  addInt("icon_size", config::DEFAULT_ICON_SIZE);
+  addInt("padding", config::DEFAULT_PADDING);
+  addString("position", "center");
+  addString("icon_dir", "");
+  addInt("texture_budget_kb", config::DEFAULT_TEXTURE_BUDGET_KB);
+  addString("font", config::DEFAULT_FONT);
+  addInt("font_size", config::DEFAULT_FONT_SIZE);
+  addString("log_level", "info");
+
+  // Per-type overrides; empty or negative means inherit the above.
+  for (size_t i = 0; i < OVERLAY_TYPE_COUNT; ++i) {
+    const char* name = typeKey((OverlayType)i);
+    if (!name) continue;
+    std::string prefix = std::string(name) + ":";
+    addString(prefix + "position", "");
+    addString(prefix + "icon", "");
+    addInt(prefix + "display_ms", -1);
+    addInt(prefix + "fade_ms", -1);
+  }
+}
+
+std::vector<IconId> reload() {
+  Table table;
+  std::string dir = readString("icon_dir");
+  table.iconDir = dir.empty() ? config::getIconDir() : dir;
+  while (table.iconDir.size() > 1 && table.iconDir.back() == '/') {
+    table.iconDir.pop_back();
+  }
+  table.textureBudgetBytes =
+      (size_t)std::max<Hyprlang::INT>(readInt("texture_budget_kb"), 0) * 1024;
+  table.font = readString("font");
+  if (table.font.empty()) table.font = config::DEFAULT_FONT;
+  table.fontSize = std::max<Hyprlang::INT>(readInt("font_size"), 1);
+  table.logLevel = parseLogLevel(readString("log_level"));
+
+  OverlayConfig base;
+  base.displayMs = std::max<Hyprlang::INT>(readInt("display_ms"), 0);
+  base.fadeMs = std::max<Hyprlang::INT>(readInt("fade_ms"), 0);
+  base.iconSize = std::max<Hyprlang::INT>(readInt("icon_size"), 0);
+  base.padding = readInt("padding");
+  base.position = parsePosition(readString("position"));
+
+  for (size_t i = 0; i < OVERLAY_TYPE_COUNT; ++i) {
+    auto type = (OverlayType)i;
+    OverlayConfig cfg = base;
+    cfg.icon = config::getDefaultIcon(type);
+    std::string icon = config::getDefaultIconName(type);
+
+    if (const char* name = typeKey(type)) {
+      std::string prefix = std::string(name) + ":";
+      std::string position = readString(prefix + "position");
+      if (!position.empty()) cfg.position = parsePosition(position);
+      std::string iconName = readString(prefix + "icon");
+      if (!iconName.empty()) icon = iconName;
+      Hyprlang::INT displayMs = readInt(prefix + "display_ms");
+      if (displayMs >= 0) cfg.displayMs = displayMs;
+      Hyprlang::INT fadeMs = readInt(prefix + "fade_ms");
+      if (fadeMs >= 0) cfg.fadeMs = fadeMs;
+    }
+
+    table.types[i] = cfg;
+    resolveIcons(table, type, icon);
+  }
+
+  return install(std::move(table));
+}
+
+}  // namespace settings
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include "types.hpp"
+
+/**
+ * Live overlay settings, resolved from the plugin:superglue:* config
+ * values whenever Hyprland reloads its config. Lookups are plain
+ * array indexing, so render code can use them per icon per frame.
+ * Main thread only.
+ *
+ * The table itself (settings-store.cpp) has no Hyprland dependency;
+ * only registerValues() and reload() talk to the config manager.
+ */
+namespace settings {
+
+constexpr size_t OVERLAY_TYPE_COUNT = (size_t)OverlayType::SCROLL_ANCHOR + 1;
+
+struct Table {
+  std::array<OverlayConfig, OVERLAY_TYPE_COUNT> types;
+  std::array<std::string, (size_t)IconId::COUNT> iconPaths;
+  std::string iconDir;
+  size_t textureBudgetBytes = 0;
+  std::string font;  // Text primitives
+  int fontSize = 0;
+  LogLevel logLevel = LogLevel::INFO;
+};
+
+/**
+ * Returns the active table; defaults until the first reload().
+ */
+const Table& current();
+
+inline const OverlayConfig& forType(OverlayType type) {
+  return current().types[(size_t)type];
+}
+
+inline const std::string& iconPath(IconId icon) {
+  return current().iconPaths[(size_t)icon];
+}
+
+inline const std::string& iconDir() {
+  return current().iconDir;
+}
+
+inline const std::string& font() {
+  return current().font;
+}
+
+inline int fontSize() {
+  return current().fontSize;
+}
+
+/**
+ * Returns the built-in settings, with icons resolved under iconDir.
+ */
+Table defaults(const std::string& iconDir);
+
+/**
+ * Fills the icon file paths for one type from its base name: the
+ * anchor has _up/_down variants, volume levels append 0..13.
+ */
+void resolveIcons(Table& table, OverlayType type, const std::string& base);
+
+/**
+ * Makes table the active one.
+ * Returns the icons whose file path changed.
+ */
+std::vector<IconId> install(Table table);
+
+/**
+ * Registers every config value with Hyprland.
+ */
+void registerValues();
+
+/**
+ * Re-reads the config values into a new table.
+ * Returns the icons whose file path changed.
+ */
+std::vector<IconId> reload();
+
+}  // namespace settings
@@ -0,0 +1,203 @@
+#include "shape-batch.hpp"
+#include "render-utils.hpp"
+#include <algorithm>
+#include <cmath>
+
+static const char* VERTEX_SHADER = R"#(#version 300 es
+precision highp float;
+uniform mat3 proj;
+in vec2 pos;
+in vec2 local;
+in vec4 shape;
+in vec4 color;
+out vec2 v_local;
+out vec4 v_shape;
+out vec4 v_color;
+
+void main() {
+  gl_Position = vec4(proj * vec3(pos, 1.0), 1.0);
+  v_local = local;
+  v_shape = shape;
+  v_color = color;
+}
+)#";
+
+static const char* FRAGMENT_SHADER = R"#(#version 300 es
+precision highp float;
+in vec2 v_local;
+in vec4 v_shape;  // half width, half height, corner radius, ring width
+in vec4 v_color;
+layout(location = 0) out vec4 fragColor;
+
+// Signed distance to a box with rounded corners.
+float roundedBox(vec2 p, vec2 halfSize, float radius) {
+  vec2 q = abs(p) - halfSize + radius;
+  return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+}
+
+void main() {
+  float dist = roundedBox(v_local, v_shape.xy, v_shape.z);
+  if (v_shape.w > 0.0) {
+    // Keep a band of the ring width just inside the edge.
+    dist = abs(dist + v_shape.w * 0.5) - v_shape.w * 0.5;
+  }
+  float coverage = clamp(0.5 - dist, 0.0, 1.0);
+  fragColor = v_color * coverage;
+}
+)#";
+
+// Quads extend past the shape so the antialiased edge is not cut.
+static constexpr float AA_MARGIN = 1.0f;
+
+ShapeBatch& ShapeBatch::get() {
+  static ShapeBatch instance;
+  return instance;
+}
+
+void ShapeBatch::addRect(
+    const CBox& box,
+    const CHyprColor& color,
+    float radius,
+    float ring) {
+  if (box.w <= 0 || box.h <= 0) return;
+  Vector2D center = {box.x + box.w / 2.0, box.y + box.h / 2.0};
+  addShape(center, {1, 0}, {box.w / 2.0, box.h / 2.0}, radius, ring, color);
+}
+
+void ShapeBatch::addCircle(
+    const Vector2D& center,
+    float radius,
+    const CHyprColor& color,
+    float ring) {
+  if (radius <= 0.0f) return;
+  addShape(center, {1, 0}, {radius, radius}, radius, ring, color);
+}
+
+void ShapeBatch::addLine(
+    const Vector2D& from,
+    const Vector2D& to,
+    float thickness,
+    const CHyprColor& color) {
+  if (thickness <= 0.0f) return;
+  Vector2D diff = to - from;
+  double len = std::sqrt(diff.x * diff.x + diff.y * diff.y);
+  Vector2D axis = len > 0.0 ? diff / len : Vector2D{1, 0};
+
+  // A capsule: the caps are the corners of a fully rounded box.
+  float half = thickness / 2.0f;
+  addShape((from + to) / 2.0, axis, {len / 2.0 + half, half}, half, 0.0f,
+           color);
+}
+
+void ShapeBatch::addProgress(
+    const CBox& box,
+    float value,
+    const CHyprColor& fill,
+    const CHyprColor& background,
+    float radius) {
+  addRect(box, background, radius);
+
+  CBox filled = box;
+  filled.w = box.w * std::clamp(value, 0.0f, 1.0f);
+  addRect(filled, fill, radius);
+}
+
+void ShapeBatch::addShape(
+    const Vector2D& center,
+    const Vector2D& axis,
+    const Vector2D& halfSize,
+    float radius,
+    float ring,
+    const CHyprColor& color) {
+  if (color.a <= 0.0f) return;
+
+  float hw = halfSize.x, hh = halfSize.y;
+  radius = std::clamp(radius, 0.0f, std::min(hw, hh));
+  float r = color.r * color.a, g = color.g * color.a;
+  float b = color.b * color.a, a = color.a;
+
+  Vector2D normal = {-axis.y, axis.x};
+  float ex = hw + AA_MARGIN, ey = hh + AA_MARGIN;
+  auto corner = [&](float sx, float sy) -> Vertex {
+    Vector2D p = center + axis * (sx * ex) + normal * (sy * ey);
+    return {(float)p.x, (float)p.y, sx * ex, sy * ey,
+            hw, hh, radius, ring, r, g, b, a};
+  };
+
+  Vertex v00 = corner(-1, -1), v10 = corner(1, -1);
+  Vertex v01 = corner(-1, 1), v11 = corner(1, 1);
+  m_vertices.push_back(v00);
+  m_vertices.push_back(v10);
+  m_vertices.push_back(v01);
+  m_vertices.push_back(v10);
+  m_vertices.push_back(v11);
+  m_vertices.push_back(v01);
+}
+
+bool ShapeBatch::initGL() {
+  if (m_program) return true;
+  if (m_glFailed) return false;
+
+  m_program = render::compileProgram(VERTEX_SHADER, FRAGMENT_SHADER);
+  if (!m_program) {
+    m_glFailed = true;
+    return false;
+  }
+
+  m_projLoc = glGetUniformLocation(m_program, "proj");
+  GLint posLoc = glGetAttribLocation(m_program, "pos");
+  GLint localLoc = glGetAttribLocation(m_program, "local");
+  GLint shapeLoc = glGetAttribLocation(m_program, "shape");
+  GLint colorLoc = glGetAttribLocation(m_program, "color");
+
+  glGenVertexArrays(1, &m_vao);
+  glGenBuffers(1, &m_vbo);
+  glBindVertexArray(m_vao);
+  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+
+  glEnableVertexAttribArray(posLoc);
+  glVertexAttribPointer(posLoc, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                        (void*)offsetof(Vertex, x));
+  glEnableVertexAttribArray(localLoc);
+  glVertexAttribPointer(localLoc, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                        (void*)offsetof(Vertex, lx));
+  glEnableVertexAttribArray(shapeLoc);
+  glVertexAttribPointer(shapeLoc, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                        (void*)offsetof(Vertex, hw));
+  glEnableVertexAttribArray(colorLoc);
+  glVertexAttribPointer(colorLoc, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                        (void*)offsetof(Vertex, r));
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  return true;
+}
+
+void ShapeBatch::flush() {
+  if (m_vertices.empty() || !initGL()) {
+    m_vertices.clear();
+    return;
+  }
+
+  auto proj = render::pixelProjection();
+
+  g_pHyprOpenGL->blend(true);
+  glUseProgram(m_program);
+  glUniformMatrix3fv(m_projLoc, 1, GL_TRUE, proj.data());
+
+  glBindVertexArray(m_vao);
+  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+  glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(Vertex),
+               m_vertices.data(), GL_STREAM_DRAW);
+
+  GLsizei count = m_vertices.size();
+  render::forEachDamageRect([count] {
+    glDrawArrays(GL_TRIANGLES, 0, count);
+  });
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+  glUseProgram(0);
+
+  m_vertices.clear();
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <hyprland/src/render/OpenGL.hpp>
+#include <vector>
+
+/**
+ * Collects vector shapes and draws them with one SDF shader in a
+ * single call per damage rect.
+ *
+ * Every shape is an oriented rounded box: rects, circles and line
+ * segments differ only in size, corner radius and orientation, and
+ * an optional ring width turns the fill into an outline. Shapes are
+ * drawn in submission order with antialiased edges. Buffers are
+ * kept between flushes, so steady-state batching does not allocate.
+ */
+class ShapeBatch {
+ public:
+  static ShapeBatch& get();
+
+  /**
+   * Queues a rect (monitor-local pixels) with rounded corners. A
+   * positive ring draws only an outline that wide.
+   */
+  void addRect(
+      const CBox& box,
+      const CHyprColor& color,
+      float radius = 0.0f,
+      float ring = 0.0f);
+
+  /**
+   * Queues a filled circle, or a ring if ring is positive.
+   */
+  void addCircle(
+      const Vector2D& center,
+      float radius,
+      const CHyprColor& color,
+      float ring = 0.0f);
+
+  /**
+   * Queues a line segment with round caps.
+   */
+  void addLine(
+      const Vector2D& from,
+      const Vector2D& to,
+      float thickness,
+      const CHyprColor& color);
+
+  /**
+   * Queues a progress bar: background over the whole box, then fill
+   * over the leading value (0..1) of it.
+   */
+  void addProgress(
+      const CBox& box,
+      float value,
+      const CHyprColor& fill,
+      const CHyprColor& background,
+      float radius = 0.0f);
+
+  /**
+   * Draws everything queued, in submission order, and resets.
+   */
+  void flush();
+
+ private:
+  ShapeBatch() = default;
+
+  bool initGL();
+
+  /**
+   * Queues a box centred on center whose local x axis is axis (unit
+   * length), with the given half extents.
+   */
+  void addShape(
+      const Vector2D& center,
+      const Vector2D& axis,
+      const Vector2D& halfSize,
+      float radius,
+      float ring,
+      const CHyprColor& color);
+
+  struct Vertex {
+    float x, y;          // Monitor-local position
+    float lx, ly;        // Position in the shape's own frame
+    float hw, hh;        // Half extents
+    float radius, ring;
+    float r, g, b, a;    // Premultiplied colour
+  };
+
+  std::vector<Vertex> m_vertices;
+
+  GLuint m_program = 0;
+  GLuint m_vao = 0;
+  GLuint m_vbo = 0;
+  GLint m_projLoc = -1;
+  bool m_glFailed = false;
+};
@@ -0,0 +1,48 @@
+#include "shm-ring.hpp"
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+
+ShmRing::~ShmRing() {
+  if (m_header) munmap(m_header, m_size);
+  if (m_memFd >= 0) close(m_memFd);
+  if (m_eventFd >= 0) close(m_eventFd);
+}
+
+bool ShmRing::create(uint32_t capacity) {
+  if (capacity == 0 || (capacity & (capacity - 1)) != 0) return false;
+
+  m_memFd = memfd_create(
+      "superglue-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (m_memFd < 0) return false;
+
+  m_size = ring::mappingSize(capacity);
+  if (ftruncate(m_memFd, m_size) != 0) return false;
+
+  // Producers must not be able to shrink the file under our mapping,
+  // which would turn their next truncate into a compositor SIGBUS.
+  fcntl(m_memFd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+
+  void* mem = mmap(nullptr, m_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED, m_memFd, 0);
+  if (mem == MAP_FAILED) return false;
+
+  m_header = new (mem) ring::Header();
+  m_header->magic = ring::MAGIC;
+  m_header->version = ring::VERSION;
+  m_header->capacity = capacity;
+  m_header->recordSize = sizeof(OverlayCommand);
+  m_header->head.store(0, std::memory_order_relaxed);
+  m_header->tail.store(0, std::memory_order_relaxed);
+  m_capacity = capacity;
+
+  m_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  return m_eventFd >= 0;
+}
+
+void ShmRing::ackEvent() {
+  uint64_t count;
+  read(m_eventFd, &count, sizeof(count));
+}
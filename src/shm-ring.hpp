@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "command.hpp"
+#include "primitive.hpp"
+
+/**
+ * Shared-memory layout of the binary command ring.
+ * Producers map the memfd handed out by `ring-attach`, write
+ * records at head and publish them with a release store; the
+ * plugin is the single consumer and advances tail.
+ */
+namespace ring {
+
+constexpr uint32_t MAGIC = 0x31524753;  // "SGR1"
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t DEFAULT_CAPACITY = 1024;
+
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t capacity;    // Record slots, power of two
+  uint32_t recordSize;  // sizeof(OverlayCommand)
+  alignas(64) std::atomic<uint32_t> head;  // Written by the producer
+  alignas(64) std::atomic<uint32_t> tail;  // Written by the consumer
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(sizeof(Header) % alignof(OverlayCommand) == 0);
+
+inline size_t mappingSize(uint32_t capacity) {
+  return sizeof(Header) + capacity * sizeof(OverlayCommand);
+}
+
+inline OverlayCommand* records(Header* header) {
+  return reinterpret_cast<OverlayCommand*>(header + 1);
+}
+
+/**
+ * Producer side: appends a record, returning false when full.
+ * The caller signals the eventfd after one or more pushes.
+ */
+inline bool push(Header* header, const OverlayCommand& cmd) {
+  uint32_t head = header->head.load(std::memory_order_relaxed);
+  uint32_t tail = header->tail.load(std::memory_order_acquire);
+  if (head - tail >= header->capacity) return false;
+
+  std::memcpy(&records(header)[head & (header->capacity - 1)],
+              &cmd, sizeof(cmd));
+  header->head.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+/**
+ * Consumer side: returns whether a record is acted on. Only client
+ * ops are, and no text, whose strings can't cross the ring.
+ */
+inline bool accepts(const OverlayCommand& cmd) {
+  if (!isClientOp(cmd.op)) return false;
+  return cmd.op != CommandOp::PRIM_SET ||
+      cmd.flags != (uint16_t)PrimitiveField::TEXT;
+}
+
+}  // namespace ring
+
+/**
+ * Consumer side of one producer's command ring.
+ * Owns the memfd mapping and the eventfd the producer signals.
+ */
+class ShmRing {
+ public:
+  ShmRing() = default;
+  ~ShmRing();
+
+  ShmRing(const ShmRing&) = delete;
+  ShmRing& operator=(const ShmRing&) = delete;
+
+  /**
+   * Creates and maps a sealed memfd with capacity record slots.
+   */
+  bool create(uint32_t capacity = ring::DEFAULT_CAPACITY);
+
+  int memFd() const { return m_memFd; }
+  int eventFd() const { return m_eventFd; }
+  uint32_t capacity() const { return m_capacity; }
+
+  /**
+   * Acknowledges the eventfd and hands every published record the
+   * ring accepts to fn. Each record is copied out of shared memory
+   * before it is checked, so the producer can't change it afterwards.
+   * Returns the number of records handed over.
+   */
+  template <typename Fn>
+  size_t drain(Fn&& fn);
+
+ private:
+  void ackEvent();
+
+  ring::Header* m_header = nullptr;
+  size_t m_size = 0;
+  uint32_t m_capacity = 0;
+  int m_memFd = -1;
+  int m_eventFd = -1;
+};
+
+template <typename Fn>
+size_t ShmRing::drain(Fn&& fn) {
+  ackEvent();
+
+  const OverlayCommand* slots = ring::records(m_header);
+  uint32_t tail = m_header->tail.load(std::memory_order_relaxed);
+  uint32_t head = m_header->head.load(std::memory_order_acquire);
+
+  // A producer that scribbled over head can't make us read out of
+  // bounds: resynchronise and drop whatever it claimed to publish.
+  if (head - tail > m_capacity) tail = head;
+
+  size_t count = 0;
+  for (; tail != head; ++tail) {
+    OverlayCommand record;
+    std::memcpy(&record, &slots[tail & (m_capacity - 1)], sizeof(record));
+    if (!ring::accepts(record)) continue;
+    fn(record);
+    ++count;
+  }
+  m_header->tail.store(tail, std::memory_order_release);
+  return count;
+}
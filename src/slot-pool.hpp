@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Object pool addressed by generation-checked handles.
+ * Objects never move, so they can be updated in place; freed slots
+ * are recycled, and a handle to a destroyed object stops resolving
+ * because its slot's generation has moved on.
+ */
+template <typename T>
+class SlotPool {
+ public:
+  using Handle = uint64_t;  // generation << 32 | index; 0 is never valid
+
+  explicit SlotPool(size_t maxSize) : m_maxSize(maxSize) {}
+
+  /**
+   * Allocates a default-constructed object. Returns 0 when full.
+   */
+  Handle create() {
+    uint32_t index;
+    if (!m_free.empty()) {
+      index = m_free.back();
+      m_free.pop_back();
+    } else {
+      if (m_slots.size() >= m_maxSize) return 0;
+      index = m_slots.size();
+      m_slots.emplace_back();
+    }
+
+    Slot& slot = m_slots[index];
+    slot.value = T{};
+    slot.alive = true;
+    ++m_size;
+    return makeHandle(index, slot.generation);
+  }
+
+  /**
+   * Returns the object for handle, or nullptr if it was destroyed.
+   */
+  T* get(Handle handle) {
+    uint32_t index = (uint32_t)handle;
+    if (index >= m_slots.size()) return nullptr;
+    Slot& slot = m_slots[index];
+    if (!slot.alive || slot.generation != (uint32_t)(handle >> 32)) {
+      return nullptr;
+    }
+    return &slot.value;
+  }
+
+  const T* get(Handle handle) const {
+    return const_cast<SlotPool*>(this)->get(handle);
+  }
+
+  /**
+   * Frees the object for handle. Returns false if already gone.
+   */
+  bool destroy(Handle handle) {
+    if (!get(handle)) return false;
+    uint32_t index = (uint32_t)handle;
+    Slot& slot = m_slots[index];
+    slot.alive = false;
+    if (++slot.generation == 0) slot.generation = 1;
+    m_free.push_back(index);
+    --m_size;
+    return true;
+  }
+
+  /**
+   * Calls fn(handle, object) for every live object. fn may destroy
+   * the object it was given.
+   */
+  template <typename Fn>
+  void forEach(Fn&& fn) {
+    for (size_t i = 0; i < m_slots.size(); ++i) {
+      Slot& slot = m_slots[i];
+      if (slot.alive) fn(makeHandle(i, slot.generation), slot.value);
+    }
+  }
+
+  size_t size() const { return m_size; }
+
+ private:
+  struct Slot {
+    T value{};
+    uint32_t generation = 1;
+    bool alive = false;
+  };
+
+  static Handle makeHandle(uint32_t index, uint32_t generation) {
+    return ((Handle)generation << 32) | index;
+  }
+
+  std::vector<Slot> m_slots;
+  std::vector<uint32_t> m_free;
+  size_t m_size = 0;
+  size_t m_maxSize;
+};
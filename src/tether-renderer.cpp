@@ -0,0 +1,149 @@
+#include "tether-renderer.hpp"
+#include "render-utils.hpp"
+#include <cmath>
+
+static const char* VERTEX_SHADER = R"#(#version 300 es
+precision highp float;
+uniform mat3 proj;
+in vec2 pos;
+out vec2 v_pos;
+
+void main() {
+  gl_Position = vec4(proj * vec3(pos, 1.0), 1.0);
+  v_pos = pos;
+}
+)#";
+
+static const char* FRAGMENT_SHADER = R"#(#version 300 es
+precision highp float;
+uniform vec2 anchor;
+uniform vec2 dir;
+uniform float len;
+uniform float spacing;
+uniform float dots;
+uniform float size;
+uniform vec4 color;
+in vec2 v_pos;
+layout(location = 0) out vec4 fragColor;
+
+// Signed distance to an axis-aligned square with rounded corners.
+float roundedSquare(vec2 p, float halfSize, float radius) {
+  vec2 q = abs(p) - vec2(halfSize - radius);
+  return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+}
+
+void main() {
+  vec2 rel = v_pos - anchor;
+  float along = dot(rel, dir);
+  float dist;
+
+  if (spacing > 0.0) {
+    // Only the nearest dot can cover this pixel: dots are spaced
+    // further apart than they are wide.
+    float k = clamp(floor(along / spacing + 0.5), 1.0, dots);
+    vec2 center = anchor + dir * (k * spacing);
+    dist = roundedSquare(v_pos - center, size * 0.5, min(1.0, size * 0.5));
+  } else {
+    float across = abs(dot(rel, vec2(-dir.y, dir.x)));
+    dist = max(across - size * 0.5, max(-along, along - len));
+  }
+
+  float coverage = clamp(0.5 - dist, 0.0, 1.0);
+  fragColor = vec4(color.rgb * color.a, color.a) * coverage;
+}
+)#";
+
+TetherRenderer& TetherRenderer::get() {
+  static TetherRenderer instance;
+  return instance;
+}
+
+bool TetherRenderer::initGL() {
+  if (m_program) return true;
+  if (m_glFailed) return false;
+
+  m_program = render::compileProgram(VERTEX_SHADER, FRAGMENT_SHADER);
+  if (!m_program) {
+    m_glFailed = true;
+    return false;
+  }
+
+  m_projLoc = glGetUniformLocation(m_program, "proj");
+  m_anchorLoc = glGetUniformLocation(m_program, "anchor");
+  m_dirLoc = glGetUniformLocation(m_program, "dir");
+  m_lenLoc = glGetUniformLocation(m_program, "len");
+  m_spacingLoc = glGetUniformLocation(m_program, "spacing");
+  m_dotsLoc = glGetUniformLocation(m_program, "dots");
+  m_sizeLoc = glGetUniformLocation(m_program, "size");
+  m_colorLoc = glGetUniformLocation(m_program, "color");
+  GLint posLoc = glGetAttribLocation(m_program, "pos");
+
+  glGenVertexArrays(1, &m_vao);
+  glGenBuffers(1, &m_vbo);
+  glBindVertexArray(m_vao);
+  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+  glBufferData(GL_ARRAY_BUFFER, 8 * sizeof(float), nullptr, GL_STREAM_DRAW);
+  glEnableVertexAttribArray(posLoc);
+  glVertexAttribPointer(posLoc, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  return true;
+}
+
+int TetherRenderer::draw(
+    const Vector2D& from,
+    const Vector2D& to,
+    float thickness,
+    float spacing,
+    const CHyprColor& color) {
+  Vector2D diff = to - from;
+  float len = std::sqrt(diff.x * diff.x + diff.y * diff.y);
+  if (len <= 0.1f || color.a <= 0.0f) return 0;
+
+  // Dots sit at spacing, 2 * spacing, ... strictly before the end.
+  float dots = spacing > 0.0f ? std::ceil(len / spacing) - 1.0f : 0.0f;
+  if (spacing > 0.0f && dots < 1.0f) return 0;
+
+  if (!initGL()) return 0;
+
+  // Quad along the line, padded enough to hold an axis-aligned dot
+  // at any angle plus a pixel of antialiasing.
+  Vector2D dir = diff / len;
+  Vector2D normal = {-dir.y, dir.x};
+  float margin = thickness + 1.0f;
+  Vector2D start = from - dir * margin;
+  Vector2D end = to + dir * margin;
+  Vector2D side = normal * margin;
+
+  float quad[8] = {
+      (float)(start.x - side.x), (float)(start.y - side.y),
+      (float)(start.x + side.x), (float)(start.y + side.y),
+      (float)(end.x - side.x),   (float)(end.y - side.y),
+      (float)(end.x + side.x),   (float)(end.y + side.y),
+  };
+
+  auto proj = render::pixelProjection();
+
+  g_pHyprOpenGL->blend(true);
+  glUseProgram(m_program);
+  glUniformMatrix3fv(m_projLoc, 1, GL_TRUE, proj.data());
+  glUniform2f(m_anchorLoc, from.x, from.y);
+  glUniform2f(m_dirLoc, dir.x, dir.y);
+  glUniform1f(m_lenLoc, len);
+  glUniform1f(m_spacingLoc, spacing);
+  glUniform1f(m_dotsLoc, dots);
+  glUniform1f(m_sizeLoc, thickness);
+  glUniform4f(m_colorLoc, color.r, color.g, color.b, color.a);
+
+  glBindVertexArray(m_vao);
+  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(quad), quad);
+
+  render::forEachDamageRect([] { glDrawArrays(GL_TRIANGLE_STRIP, 0, 4); });
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+  glUseProgram(0);
+  return (int)dots;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <hyprland/src/render/OpenGL.hpp>
+
+/**
+ * Draws the dotted scroll-anchor tether as a single oriented quad.
+ * The fragment shader places the dots and antialiases them, so the
+ * cost is one draw per damage rect however long the line is.
+ */
+class TetherRenderer {
+ public:
+  static TetherRenderer& get();
+
+  /**
+   * Draws dots of the given thickness every spacing pixels from
+   * 'from' towards 'to' (monitor-local pixels), excluding both ends.
+   * A spacing of zero or less draws a solid line instead. Returns
+   * the number of dots drawn.
+   */
+  int draw(
+      const Vector2D& from,
+      const Vector2D& to,
+      float thickness,
+      float spacing,
+      const CHyprColor& color);
+
+ private:
+  TetherRenderer() = default;
+
+  bool initGL();
+
+  GLuint m_program = 0;
+  GLuint m_vao = 0;
+  GLuint m_vbo = 0;
+  GLint m_projLoc = -1;
+  GLint m_anchorLoc = -1;
+  GLint m_dirLoc = -1;
+  GLint m_lenLoc = -1;
+  GLint m_spacingLoc = -1;
+  GLint m_dotsLoc = -1;
+  GLint m_sizeLoc = -1;
+  GLint m_colorLoc = -1;
+  bool m_glFailed = false;
+};
@@ -0,0 +1,314 @@
+#include "text-cache.hpp"
+#include "icon-batch.hpp"
+#include "render-utils.hpp"
+#include "config.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cairo/cairo.h>
+
+// Characters served from the glyph atlas.
+static constexpr char GLYPH_CHARS[] = "0123456789%.,:+-/ ";
+static constexpr size_t GLYPH_COUNT = sizeof(GLYPH_CHARS) - 1;
+
+// Clear margin around text, so ink that spills past the advance
+// (bearings, antialiasing) is not clipped.
+static constexpr int TEXT_PAD = 2;
+
+static int glyphIndex(char c) {
+  const char* found = c ? std::strchr(GLYPH_CHARS, c) : nullptr;
+  return found ? (int)(found - GLYPH_CHARS) : -1;
+}
+
+static void selectFont(cairo_t* cr, const std::string& font, int size) {
+  cairo_select_font_face(
+      cr, font.c_str(), CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+  cairo_set_font_size(cr, size);
+}
+
+// Runs fn on a scratch context with font selected, for metrics only.
+template <typename Fn>
+static void withFont(const std::string& font, int size, Fn&& fn) {
+  cairo_surface_t* surface =
+      cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
+  cairo_t* cr = cairo_create(surface);
+  selectFont(cr, font, size);
+  fn(cr);
+  cairo_destroy(cr);
+  cairo_surface_destroy(surface);
+}
+
+// Paints white text with fn into a w x h surface and copies the
+// pixels out. Leaves out empty on failure.
+template <typename Fn>
+static void paint(
+    int w,
+    int h,
+    const std::string& font,
+    int size,
+    std::vector<uint32_t>& out,
+    Fn&& fn) {
+  out.clear();
+  cairo_surface_t* surface =
+      cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h);
+  if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+    cairo_surface_destroy(surface);
+    return;
+  }
+
+  cairo_t* cr = cairo_create(surface);
+  selectFont(cr, font, size);
+  cairo_set_source_rgba(cr, 1.0, 1.0, 1.0, 1.0);
+  fn(cr);
+  cairo_destroy(cr);
+  cairo_surface_flush(surface);
+
+  const unsigned char* src = cairo_image_surface_get_data(surface);
+  int stride = cairo_image_surface_get_stride(surface);
+  out.resize((size_t)w * h);
+  for (int y = 0; y < h; ++y) {
+    std::memcpy(out.data() + (size_t)y * w, src + (size_t)y * stride,
+                (size_t)w * sizeof(uint32_t));
+  }
+  cairo_surface_destroy(surface);
+}
+
+// Size and baseline of a whole-label bitmap: the advance plus
+// padding, one line high.
+struct LabelMetrics {
+  int w = 0, h = 0;
+  double ascent = 0;
+};
+
+static LabelMetrics labelMetrics(
+    const std::string& text,
+    const std::string& font,
+    int size) {
+  cairo_font_extents_t fontExtents = {};
+  cairo_text_extents_t textExtents = {};
+  withFont(font, size, [&](cairo_t* cr) {
+    cairo_font_extents(cr, &fontExtents);
+    cairo_text_extents(cr, text.c_str(), &textExtents);
+  });
+
+  LabelMetrics metrics;
+  metrics.w = (int)std::ceil(textExtents.x_advance) + 2 * TEXT_PAD;
+  metrics.h = (int)std::ceil(fontExtents.ascent + fontExtents.descent) +
+      2 * TEXT_PAD;
+  metrics.ascent = fontExtents.ascent;
+  return metrics;
+}
+
+TextCache& TextCache::get() {
+  static TextCache instance;
+  return instance;
+}
+
+Vector2D TextCache::measure(
+    const std::string& text,
+    const std::string& font,
+    int size) {
+  if (text.empty() || size <= 0) return {};
+
+  if (usesGlyphs(text)) {
+    // Mirror the per-glyph rounding in draw().
+    GlyphSet& set = glyphSet(font, size);
+    float pen = 0;
+    double width = 0;
+    for (char c : text) {
+      const Glyph& glyph = set.glyphs[glyphIndex(c)];
+      width = std::max(width, (double)std::round(pen) + glyph.w);
+      pen += glyph.advance;
+    }
+    return {width, (double)set.height};
+  }
+
+  // Damage is sized for windows that may never be drawn, so a label
+  // only gets rasterized and cached once draw() needs it.
+  auto found = m_labels.find(makeKey(text, font, size));
+  if (found != m_labels.end()) return found->second.region.size;
+  LabelMetrics metrics = labelMetrics(text, font, size);
+  return {(double)metrics.w, (double)metrics.h};
+}
+
+void TextCache::draw(
+    const std::string& text,
+    const std::string& font,
+    int size,
+    const Vector2D& pos,
+    const CHyprColor& color) {
+  if (text.empty() || size <= 0) return;
+
+  // Snap to whole pixels; the textures are sampled linearly.
+  Vector2D origin = {std::round(pos.x), std::round(pos.y)};
+
+  if (usesGlyphs(text)) {
+    GlyphSet& set = glyphSet(font, size);
+    if (!set.texture && !set.bitmap.pixels.empty()) {
+      set.texture = render::createTexture(
+          set.bitmap.w, set.bitmap.h, set.bitmap.pixels.data(), GL_LINEAR);
+      for (auto& glyph : set.glyphs) {
+        glyph.region.texture = set.texture;
+        glyph.region.uvTopLeft = {(double)glyph.x / set.bitmap.w, 0};
+        glyph.region.uvBottomRight = {
+            (double)(glyph.x + glyph.w) / set.bitmap.w, 1};
+        glyph.region.size = {(double)glyph.w, (double)set.height};
+      }
+      set.bitmap = {};
+    }
+
+    // Every glyph shares the atlas texture, so IconBatch draws the
+    // whole string as one run.
+    float pen = 0;
+    for (char c : text) {
+      const Glyph& glyph = set.glyphs[glyphIndex(c)];
+      if (c != ' ') {
+        CBox box = {origin.x + std::round(pen), origin.y,
+                    (double)glyph.w, (double)set.height};
+        IconBatch::get().add(glyph.region, box, color);
+      }
+      pen += glyph.advance;
+    }
+  } else {
+    Label& entry = label(text, font, size);
+    if (!entry.region.texture && !entry.bitmap.pixels.empty()) {
+      entry.region.texture = render::createTexture(
+          entry.bitmap.w, entry.bitmap.h, entry.bitmap.pixels.data(),
+          GL_LINEAR);
+      entry.bitmap = {};
+    }
+    CBox box = {origin.x, origin.y,
+                entry.region.size.x, entry.region.size.y};
+    IconBatch::get().add(entry.region, box, color);
+  }
+
+  evict();
+}
+
+void TextCache::beginFrame() {
+  ++m_frame;
+  // measure() can add glyph sets for windows that are never drawn.
+  evict();
+}
+
+void TextCache::clear() {
+  m_glyphSets.clear();
+  m_labels.clear();
+}
+
+bool TextCache::usesGlyphs(const std::string& text) {
+  for (char c : text) {
+    if (glyphIndex(c) < 0) return false;
+  }
+  return !text.empty();
+}
+
+std::string TextCache::makeKey(
+    const std::string& text,
+    const std::string& font,
+    int size) {
+  return font + '\n' + std::to_string(size) + '\n' + text;
+}
+
+TextCache::GlyphSet& TextCache::glyphSet(const std::string& font, int size) {
+  std::string key = makeKey("", font, size);
+  auto found = m_glyphSets.find(key);
+  if (found == m_glyphSets.end()) {
+    found = m_glyphSets.emplace(key, rasterizeGlyphs(font, size)).first;
+  }
+  found->second.lastUse = m_frame;
+  return found->second;
+}
+
+TextCache::Label& TextCache::label(
+    const std::string& text,
+    const std::string& font,
+    int size) {
+  std::string key = makeKey(text, font, size);
+  auto found = m_labels.find(key);
+  if (found == m_labels.end()) {
+    Label entry;
+    entry.bitmap = rasterizeLabel(text, font, size);
+    entry.region.size = {(double)entry.bitmap.w, (double)entry.bitmap.h};
+    found = m_labels.emplace(key, std::move(entry)).first;
+  }
+  found->second.lastUse = m_frame;
+  return found->second;
+}
+
+TextCache::Bitmap TextCache::rasterizeLabel(
+    const std::string& text,
+    const std::string& font,
+    int size) {
+  LabelMetrics metrics = labelMetrics(text, font, size);
+  Bitmap bitmap;
+  bitmap.w = metrics.w;
+  bitmap.h = metrics.h;
+  paint(bitmap.w, bitmap.h, font, size, bitmap.pixels, [&](cairo_t* cr) {
+    cairo_move_to(cr, TEXT_PAD, TEXT_PAD + metrics.ascent);
+    cairo_show_text(cr, text.c_str());
+  });
+  return bitmap;
+}
+
+TextCache::GlyphSet TextCache::rasterizeGlyphs(
+    const std::string& font,
+    int size) {
+  GlyphSet set;
+  set.glyphs.resize(GLYPH_COUNT);
+
+  // One cell per glyph in a single row, each as wide as its advance
+  // plus padding; text is then laid out by advance alone.
+  cairo_font_extents_t fontExtents = {};
+  withFont(font, size, [&](cairo_t* cr) {
+    cairo_font_extents(cr, &fontExtents);
+    int x = 0;
+    for (size_t i = 0; i < GLYPH_COUNT; ++i) {
+      char str[2] = {GLYPH_CHARS[i], '\0'};
+      cairo_text_extents_t extents = {};
+      cairo_text_extents(cr, str, &extents);
+
+      Glyph& glyph = set.glyphs[i];
+      glyph.advance = extents.x_advance;
+      glyph.x = x;
+      glyph.w = (int)std::ceil(extents.x_advance) + 2 * TEXT_PAD;
+      x += glyph.w;
+    }
+    set.bitmap.w = x;
+  });
+
+  set.height = (int)std::ceil(fontExtents.ascent + fontExtents.descent) +
+      2 * TEXT_PAD;
+  set.bitmap.h = set.height;
+  paint(set.bitmap.w, set.bitmap.h, font, size, set.bitmap.pixels,
+        [&](cairo_t* cr) {
+          for (size_t i = 0; i < GLYPH_COUNT; ++i) {
+            char str[2] = {GLYPH_CHARS[i], '\0'};
+            cairo_move_to(cr, set.glyphs[i].x + TEXT_PAD,
+                          TEXT_PAD + fontExtents.ascent);
+            cairo_show_text(cr, str);
+          }
+        });
+  return set;
+}
+
+void TextCache::evict() {
+  // Least recently used first; anything used this frame stays, as its
+  // texture may already be queued in IconBatch.
+  auto trim = [this](auto& entries, size_t limit) {
+    while (entries.size() > limit) {
+      auto oldest = entries.end();
+      for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->second.lastUse >= m_frame) continue;
+        if (oldest == entries.end() ||
+            it->second.lastUse < oldest->second.lastUse) {
+          oldest = it;
+        }
+      }
+      if (oldest == entries.end()) break;
+      entries.erase(oldest);
+    }
+  };
+  trim(m_labels, config::TEXT_LABEL_CACHE);
+  trim(m_glyphSets, config::TEXT_GLYPH_SETS);
+}
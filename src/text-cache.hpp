@@ -0,0 +1,104 @@
+#pragma once
+
+#include <hyprland/src/render/OpenGL.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "texture-cache.hpp"
+
+/**
+ * Rasterizes text with cairo into cached textures.
+ *
+ * Strings made only of digits and a few symbols (volume and
+ * brightness readouts) are laid out from a per-(font, size) glyph
+ * atlas, so a value that changes every frame is never rasterized
+ * again. Anything else becomes one whole-label texture, kept in a
+ * small LRU keyed by (text, font, size); a repeated label costs a
+ * single quad.
+ *
+ * measure() only takes font metrics, except for glyph atlases, which
+ * are rasterized white up front; labels are rasterized on first
+ * draw(). IconBatch tints them. Entries used
+ * during the current frame are never evicted. Main thread only.
+ */
+class TextCache {
+ public:
+  static TextCache& get();
+
+  /**
+   * Returns the pixel size of text's box. Caches no labels and does
+   * not touch GL.
+   */
+  Vector2D measure(
+      const std::string& text,
+      const std::string& font,
+      int size);
+
+  /**
+   * Queues text onto IconBatch with its box's top-left corner at pos
+   * (monitor-local pixels). Must run with the GL context current.
+   */
+  void draw(
+      const std::string& text,
+      const std::string& font,
+      int size,
+      const Vector2D& pos,
+      const CHyprColor& color);
+
+  /**
+   * Starts a new frame for LRU purposes.
+   */
+  void beginFrame();
+
+  /**
+   * Drops every cached texture.
+   */
+  void clear();
+
+ private:
+  TextCache() = default;
+
+  struct Bitmap {
+    int w = 0, h = 0;
+    std::vector<uint32_t> pixels;  // Premultiplied ARGB, tightly packed
+  };
+
+  struct Glyph {
+    float advance = 0;
+    int x = 0, w = 0;  // Cell within the atlas, padding included
+    TextureRegion region;
+  };
+
+  struct GlyphSet {
+    Bitmap bitmap;  // Released once uploaded
+    std::vector<Glyph> glyphs;  // Indexed like GLYPH_CHARS
+    SP<CTexture> texture;
+    int height = 0;
+    uint64_t lastUse = 0;
+  };
+
+  struct Label {
+    Bitmap bitmap;  // Released once uploaded
+    TextureRegion region;
+    uint64_t lastUse = 0;
+  };
+
+  static bool usesGlyphs(const std::string& text);
+  static std::string makeKey(
+      const std::string& text,
+      const std::string& font,
+      int size);
+  static Bitmap rasterizeLabel(
+      const std::string& text,
+      const std::string& font,
+      int size);
+  static GlyphSet rasterizeGlyphs(const std::string& font, int size);
+
+  GlyphSet& glyphSet(const std::string& font, int size);
+  Label& label(const std::string& text, const std::string& font, int size);
+  void evict();
+
+  std::unordered_map<std::string, GlyphSet> m_glyphSets;
+  std::unordered_map<std::string, Label> m_labels;
+  uint64_t m_frame = 1;
+};
@@ -1,4 +1,13 @@
 #include "texture-cache.hpp"
+#include "decode-pool.hpp"
+#include "config.hpp"
+#include "settings.hpp"
+#include "render-utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
 #include <cairo/cairo.h>
 
 TextureCache& TextureCache::get() {
@@ -6,66 +15,734 @@ TextureCache& TextureCache::get() {
   return instance;
 }
 
-SP<CTexture> TextureCache::load(const std::string& path) {
-  std::lock_guard<std::mutex> lock(m_mutex);
+TextureCache::TextureCache()
+    : m_iconDir(std::make_shared<const std::string>(config::getIconDir())) {
+  // Reserve room for every interned icon so growing the table never
+  // moves slots that region() pointers refer to.
+  m_icons.reserve((size_t)IconId::COUNT + config::MAX_DYNAMIC_ICONS);
+  m_icons.resize((size_t)IconId::COUNT);
+}
+
+TextureCache::~TextureCache() {
+  // Join the workers before the result list they write to goes away.
+  m_pool.reset();
+}
+
+const TextureRegion* TextureCache::region(IconId icon) {
+  IconSlot* slot = slotFor(icon);
+  if (!slot) return nullptr;
+
+  if (slot->state == SlotState::READY) {
+    ++m_stats.hits;
+    slot->lastUse = m_frame;
+    return &slot->region;
+  }
+
+  ++m_stats.misses;
+  if (slot->state == SlotState::EMPTY) request(icon);
+  return slot->state == SlotState::READY ? &slot->region : nullptr;
+}
+
+const TextureRegion* TextureCache::peek(IconId icon) {
+  IconSlot* slot = slotFor(icon);
+  return slot && slot->state == SlotState::READY ? &slot->region : nullptr;
+}
 
-  auto it = m_cache.find(path);
-  if (it != m_cache.end()) {
-    return it->second.texture;
+const TextureRegion* TextureCache::variant(
+    IconId icon,
+    const Vector2D& pixelSize) {
+  IconSlot* base = slotFor(icon);
+  if (!base || base->state != SlotState::READY) return nullptr;
+
+  // Only shrinking loses detail to GPU sampling; at native size or
+  // above the icon itself is as good as a copy.
+  int w = (int)std::round(pixelSize.x);
+  int h = (int)std::round(pixelSize.y);
+  const Vector2D& native = base->region.size;
+  if (w <= 0 || h <= 0 || (w >= native.x && h >= native.y)) return nullptr;
+
+  uint64_t key = variantKey(icon, w, h);
+  IconSlot* slot = m_variants.find(key);
+  if (!slot) {
+    // Sizes that keep changing, like an animated primitive, would
+    // otherwise start a build every frame; a recent failure makes
+    // the icon wait before trying again.
+    if (m_variantBuilds >= config::MAX_VARIANT_BUILDS_PER_FRAME ||
+        m_frame < base->variantRetry) {
+      return nullptr;
+    }
+    if (m_variants.size() >= config::MAX_ICON_VARIANTS && !evictVariant()) {
+      return nullptr;
+    }
+    ++m_variantBuilds;
+    slot = &m_variants[key];
+    slot->state = SlotState::PENDING;
+    slot->lastUse = m_frame;
+    requestVariant(icon, key, w, h);
+    return nullptr;
   }
 
-  return loadFromFile(path);
+  slot->lastUse = m_frame;
+  return slot->state == SlotState::READY ? &slot->region : nullptr;
+}
+
+uint64_t TextureCache::variantKey(IconId icon, int w, int h) {
+  return ((uint64_t)icon << 32) | ((uint64_t)(w & 0xffff) << 16) |
+         (uint64_t)(h & 0xffff);
 }
 
-Vector2D TextureCache::getSize(const std::string& path) {
-  std::lock_guard<std::mutex> lock(m_mutex);
+void TextureCache::prefetch(IconId icon) {
+  IconSlot* slot = slotFor(icon);
+  if (slot && slot->state == SlotState::EMPTY) request(icon);
+}
+
+IconId TextureCache::intern(const std::string& name) {
+  // Names stay inside the icon directory.
+  if (name.empty() || name.find('/') != std::string::npos ||
+      name.starts_with(".")) {
+    return IconId::NONE;
+  }
 
-  auto it = m_cache.find(path);
-  if (it != m_cache.end()) {
-    return it->second.size;
+  std::lock_guard<std::mutex> lock(m_namesMutex);
+  auto found = m_dynamicIds.find(name);
+  if (found != m_dynamicIds.end()) return found->second;
+  if (m_dynamicPaths.size() >= config::MAX_DYNAMIC_ICONS) {
+    return IconId::NONE;
   }
-  return {0, 0};
+
+  auto icon = (IconId)((size_t)IconId::COUNT + m_dynamicPaths.size());
+  auto dir = m_iconDir.load(std::memory_order_acquire);
+  m_dynamicPaths.push_back(*dir + "/" + name + ".png");
+  m_dynamicIds.emplace(name, icon);
+  return icon;
+}
+
+void TextureCache::setIconDir(const std::string& dir) {
+  m_iconDir.store(
+      std::make_shared<const std::string>(dir), std::memory_order_release);
+}
+
+TextureCache::IconSlot* TextureCache::slotFor(IconId icon) {
+  size_t index = (size_t)icon;
+  if (icon == IconId::NONE) return nullptr;
+  if (index < m_icons.size()) return &m_icons[index];
+
+  // First use of a freshly interned icon: grow the table.
+  std::lock_guard<std::mutex> lock(m_namesMutex);
+  if (index >= (size_t)IconId::COUNT + m_dynamicPaths.size()) return nullptr;
+  m_icons.resize((size_t)IconId::COUNT + m_dynamicPaths.size());
+  return &m_icons[index];
+}
+
+std::string TextureCache::pathOf(IconId icon) {
+  if (icon < IconId::COUNT) return settings::iconPath(icon);
+
+  std::lock_guard<std::mutex> lock(m_namesMutex);
+  return m_dynamicPaths[(size_t)icon - (size_t)IconId::COUNT];
+}
+
+void TextureCache::beginFrame() {
+  ++m_frame;
+  m_variantBuilds = 0;
+  // Copies for sizes no longer drawn (another monitor, a changed
+  // icon_size) would otherwise hold their slot until evicted.
+  if (m_frame % config::VARIANT_IDLE_FRAMES == 0) dropIdleVariants();
+}
+
+void TextureCache::setPinned(IconId icon, bool pinned) {
+  if (icon == IconId::NONE || icon >= IconId::COUNT) return;
+  m_pinned[(size_t)icon] = pinned;
+}
+
+void TextureCache::setBudget(size_t bytes) {
+  m_stats.budgetBytes = bytes;
+  evictToBudget();
+}
+
+TextureStats TextureCache::stats() const {
+  TextureStats stats = m_stats;
+  stats.decodes = m_decodes.load(std::memory_order_relaxed);
+  stats.decodeMs = m_decodeNs.load(std::memory_order_relaxed) / 1e6;
+  stats.residentIcons = 0;
+  for (const auto& slot : m_icons) {
+    if (slot.state == SlotState::READY) ++stats.residentIcons;
+  }
+  m_variants.forEach([&stats](uint64_t, const IconSlot& slot) {
+    if (slot.state == SlotState::READY) ++stats.residentVariants;
+  });
+  return stats;
+}
+
+void TextureCache::setReadyCallback(ReadyCallback callback) {
+  std::lock_guard<std::mutex> lock(m_resultMutex);
+  m_readyCallback = std::move(callback);
+}
+
+Vector2D TextureCache::getSize(IconId icon) {
+  const TextureRegion* found = region(icon);
+  return found ? found->size : Vector2D{0, 0};
 }
 
 void TextureCache::clear() {
-  std::lock_guard<std::mutex> lock(m_mutex);
-  m_cache.clear();
+  {
+    std::lock_guard<std::mutex> lock(m_resultMutex);
+    m_results.clear();
+    m_hasResults.store(false, std::memory_order_relaxed);
+  }
+  ++m_generation;
+  m_icons.assign(m_icons.size(), IconSlot{});
+  m_variants.clear();
+  m_stats.residentBytes = 0;
+  m_atlasPages.clear();
+  m_atlasRegions.clear();
+  m_atlasBytes = 0;
+  m_atlasState = AtlasState::NONE;
+  m_atlasQueued = false;
+  m_atlasStale = false;
+}
+
+void TextureCache::request(IconId icon) {
+  IconSlot& slot = m_icons[(size_t)icon];
+  slot.state = SlotState::PENDING;
+
+  if (!config::USE_ICON_ATLAS) {
+    requestStandalone(icon);
+    return;
+  }
+
+  switch (m_atlasState) {
+    case AtlasState::NONE:
+      // One job decodes and packs the whole directory; every icon
+      // requested meanwhile is resolved when it lands.
+      m_atlasState = AtlasState::PENDING;
+      requestAtlas();
+      break;
+
+    case AtlasState::PENDING:
+      break;
+
+    case AtlasState::READY: {
+      auto packed = m_atlasRegions.find(pathOf(icon));
+      if (packed != m_atlasRegions.end()) {
+        slot.region = packed->second.region;
+        slot.state = SlotState::READY;
+      } else {
+        requestStandalone(icon);
+      }
+      break;
+    }
+  }
 }
 
-SP<CTexture> TextureCache::loadFromFile(const std::string& path) {
+void TextureCache::requestAtlas() {
+  if (m_atlasQueued) {
+    m_atlasStale = true;
+    return;
+  }
+  m_atlasQueued = true;
+
+  std::string dir = settings::iconDir();
+  submit([dir](DecodeResult& result) {
+    result.kind = ResultKind::ATLAS;
+    packAtlas(dir, result);
+  });
+}
+
+void TextureCache::requestStandalone(IconId icon) {
+  std::string path = pathOf(icon);
+  submit([icon, path](DecodeResult& result) {
+    result.kind = ResultKind::ICON;
+    result.icon = icon;
+    decodePng(path, result.image);
+  });
+}
+
+void TextureCache::requestVariant(IconId icon, uint64_t key, int w, int h) {
+  std::string path = pathOf(icon);
+  submit([key, path, w, h](DecodeResult& result) {
+    result.kind = ResultKind::VARIANT;
+    result.variant = key;
+    Image native;
+    if (decodePng(path, native)) scaleImage(native, w, h, result.image);
+  });
+}
+
+void TextureCache::invalidate(const std::vector<IconId>& icons) {
+  if (icons.empty()) return;
+
+  // Repack from the new paths; until it lands the old atlas regions
+  // keep being drawn.
+  if (config::USE_ICON_ATLAS && m_atlasState != AtlasState::NONE) {
+    requestAtlas();
+  }
+
+  for (IconId icon : icons) {
+    dropVariants(icon);
+
+    IconSlot& slot = m_icons[(size_t)icon];
+    switch (slot.state) {
+      case SlotState::FAILED:
+        slot.state = SlotState::EMPTY;
+        break;
+      case SlotState::READY:
+        // Atlas-backed slots are repointed when the repack lands.
+        if (slot.bytes != 0) requestStandalone(icon);
+        break;
+      case SlotState::PENDING:
+        if (!config::USE_ICON_ATLAS) requestStandalone(icon);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+void TextureCache::markStale(const std::vector<std::string>& paths) {
+  std::lock_guard<std::mutex> lock(m_resultMutex);
+  m_stalePaths.insert(m_stalePaths.end(), paths.begin(), paths.end());
+}
+
+void TextureCache::reloadStale() {
+  std::vector<std::string> paths;
+  {
+    std::lock_guard<std::mutex> lock(m_resultMutex);
+    paths.swap(m_stalePaths);
+  }
+
+  for (auto& path : paths) {
+    if (!path.ends_with(".png")) continue;
+    submit([path](DecodeResult& result) {
+      result.kind = ResultKind::RELOAD;
+      result.path = path;
+      decodePng(path, result.image);
+    });
+  }
+}
+
+void TextureCache::submit(std::function<void(DecodeResult&)> job) {
+  if (!m_pool) m_pool = std::make_unique<DecodePool>(config::DECODE_THREADS);
+
+  uint64_t generation = m_generation;
+  m_pool->submit([this, job = std::move(job), generation] {
+    DecodeResult result;
+    result.generation = generation;
+
+    auto start = std::chrono::steady_clock::now();
+    job(result);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    m_decodes.fetch_add(1, std::memory_order_relaxed);
+    m_decodeNs.fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+        std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(m_resultMutex);
+    m_results.push_back(std::move(result));
+    m_hasResults.store(true, std::memory_order_release);
+    if (m_readyCallback) m_readyCallback();
+  });
+}
+
+void TextureCache::uploadPending() {
+  // Cheap check first: the render path runs this every frame.
+  if (!m_hasResults.load(std::memory_order_acquire)) return;
+
+  std::vector<DecodeResult> results;
+  {
+    std::lock_guard<std::mutex> lock(m_resultMutex);
+    results.swap(m_results);
+    m_hasResults.store(false, std::memory_order_relaxed);
+  }
+
+  for (auto& result : results) {
+    if (result.generation == m_generation) applyResult(result);
+  }
+  evictToBudget();
+}
+
+void TextureCache::evictToBudget() {
+  if (m_stats.budgetBytes == 0) return;
+
+  // Linear scan for the oldest unpinned standalone texture or
+  // variant; the tables are small and eviction only runs after
+  // uploads.
+  while (m_stats.residentBytes > m_stats.budgetBytes) {
+    IconSlot* victim = nullptr;
+    uint64_t victimVariant = 0;
+    for (size_t i = 0; i < m_icons.size(); ++i) {
+      IconSlot& slot = m_icons[i];
+      if (slot.state != SlotState::READY || slot.bytes == 0) continue;
+      bool pinned = i < m_pinned.size() && m_pinned[i];
+      if (pinned || slot.lastUse >= m_frame) continue;
+      if (!victim || slot.lastUse < victim->lastUse) victim = &slot;
+    }
+    m_variants.forEach([&](uint64_t key, IconSlot& slot) {
+      if (slot.state != SlotState::READY || slot.lastUse >= m_frame) return;
+      if (!victim || slot.lastUse < victim->lastUse) {
+        victim = &slot;
+        victimVariant = key;
+      }
+    });
+    if (!victim) break;
+
+    m_stats.residentBytes -= victim->bytes;
+    ++m_stats.evictions;
+    if (victimVariant) {
+      m_variants.erase(victimVariant);
+    } else {
+      *victim = {};
+    }
+  }
+}
+
+void TextureCache::applyResult(DecodeResult& result) {
+  switch (result.kind) {
+    case ResultKind::ICON:
+      applyIcon(m_icons[(size_t)result.icon], result.image);
+      break;
+    case ResultKind::ATLAS:
+      applyAtlas(result);
+      break;
+    case ResultKind::RELOAD:
+      applyReload(result);
+      break;
+    case ResultKind::VARIANT:
+      applyVariant(result);
+      break;
+  }
+}
+
+void TextureCache::applyIcon(IconSlot& slot, const Image& image) {
+  if (image.pixels.empty()) {
+    // A failed re-decode leaves whatever is already on screen.
+    if (slot.state != SlotState::READY) slot.state = SlotState::FAILED;
+    return;
+  }
+
+  Vector2D size = {(double)image.w, (double)image.h};
+  bool standalone = slot.state == SlotState::READY && slot.bytes != 0;
+  if (standalone && slot.region.size == size) {
+    // Same dimensions: overwrite the pixels, keep the texture handle.
+    updateTexture(slot.region.texture, 0, 0, image);
+  } else {
+    m_stats.residentBytes -= slot.bytes;
+    slot.region = {};
+    slot.region.texture = render::createTexture(
+        image.w, image.h, image.pixels.data(), GL_NEAREST);
+    slot.region.size = size;
+    slot.bytes = image.pixels.size() * sizeof(uint32_t);
+    m_stats.residentBytes += slot.bytes;
+  }
+  slot.lastUse = m_frame;
+  slot.state = SlotState::READY;
+}
+
+void TextureCache::applyAtlas(DecodeResult& result) {
+  // A rebuild replaces the previous pages wholesale; slots still hold
+  // their old region, and so the old page, until repointed below.
+  m_stats.residentBytes -= m_atlasBytes;
+  m_atlasBytes = 0;
+  m_atlasPages.clear();
+  m_atlasRegions.clear();
+
+  const int size = config::ATLAS_PAGE_SIZE;
+  for (const auto& page : result.pages) {
+    m_atlasPages.push_back(render::createTexture(
+        size, page.h, page.pixels.data(), GL_NEAREST));
+    m_atlasBytes += page.pixels.size() * sizeof(uint32_t);
+  }
+  m_stats.residentBytes += m_atlasBytes;
+
+  for (const auto& placed : result.placements) {
+    int height = result.pages[placed.page].h;
+    AtlasEntry entry;
+    entry.region.texture = m_atlasPages[placed.page];
+    entry.region.uvTopLeft = {
+        (double)placed.x / size, (double)placed.y / height};
+    entry.region.uvBottomRight = {
+        (double)(placed.x + placed.w) / size,
+        (double)(placed.y + placed.h) / height};
+    entry.region.size = {(double)placed.w, (double)placed.h};
+    entry.x = placed.x;
+    entry.y = placed.y;
+    m_atlasRegions[placed.path] = entry;
+  }
+  m_atlasState = AtlasState::READY;
+  m_atlasQueued = false;
+
+  // Resolve everything that was waiting on the atlas and repoint the
+  // icons already drawn from it. Icons missing from it (too large for
+  // a page) fall back to a standalone decode.
+  for (size_t i = 0; i < m_icons.size(); ++i) {
+    IconSlot& slot = m_icons[i];
+    if (slot.state == SlotState::PENDING) {
+      request((IconId)i);
+    } else if (slot.state == SlotState::READY && slot.bytes == 0) {
+      auto packed = m_atlasRegions.find(pathOf((IconId)i));
+      if (packed != m_atlasRegions.end()) {
+        slot.region = packed->second.region;
+      } else {
+        requestStandalone((IconId)i);
+      }
+    }
+  }
+
+  // Files changed while this build was decoding; pack them again.
+  if (m_atlasStale) {
+    m_atlasStale = false;
+    requestAtlas();
+  }
+}
+
+void TextureCache::applyReload(DecodeResult& result) {
+  // An empty image means the file was half-written or removed; keep
+  // the old pixels rather than blanking the icon.
+  const Image& image = result.image;
+  if (image.pixels.empty()) return;
+
+  // A pack job still in flight may have read the old file.
+  if (m_atlasQueued) requestAtlas();
+
+  // Variants are rebuilt from the new file on their next use.
+  if (!m_variants.empty()) {
+    for (size_t i = 1; i < m_icons.size(); ++i) {
+      if (pathOf((IconId)i) == result.path) dropVariants((IconId)i);
+    }
+  }
+
+  auto packed = m_atlasRegions.find(result.path);
+  if (packed != m_atlasRegions.end()) {
+    AtlasEntry& entry = packed->second;
+    if (entry.region.size == Vector2D{(double)image.w, (double)image.h}) {
+      updateTexture(entry.region.texture, entry.x, entry.y, image);
+    } else {
+      requestAtlas();
+    }
+    return;
+  }
+
+  for (size_t i = 1; i < m_icons.size(); ++i) {
+    if (pathOf((IconId)i) != result.path) continue;
+
+    IconSlot& slot = m_icons[i];
+    bool standalone = slot.state == SlotState::READY && slot.bytes != 0;
+    if (standalone || slot.state == SlotState::FAILED) {
+      applyIcon(slot, image);
+    }
+  }
+}
+
+void TextureCache::applyVariant(DecodeResult& result) {
+  // Dropped while it was being built.
+  IconSlot* slot = m_variants.find(result.variant);
+  if (!slot) return;
+
+  if (result.image.pixels.empty()) {
+    // Free the slot; the icon is drawn unscaled for a while before
+    // another copy is attempted.
+    eraseVariant(result.variant);
+    m_icons[result.variant >> 32].variantRetry =
+        m_frame + config::VARIANT_IDLE_FRAMES;
+    return;
+  }
+  applyIcon(*slot, result.image);
+}
+
+void TextureCache::dropVariants(IconId icon) {
+  // The file changed, so a copy may work again.
+  m_icons[(size_t)icon].variantRetry = 0;
+  if (m_variants.empty()) return;
+
+  std::vector<uint64_t> keys;
+  m_variants.forEach([&](uint64_t key, const IconSlot&) {
+    if ((IconId)(key >> 32) == icon) keys.push_back(key);
+  });
+  for (uint64_t key : keys) eraseVariant(key);
+}
+
+void TextureCache::dropIdleVariants() {
+  if (m_variants.empty()) return;
+
+  std::vector<uint64_t> keys;
+  m_variants.forEach([&](uint64_t key, const IconSlot& slot) {
+    if (slot.lastUse + config::VARIANT_IDLE_FRAMES <= m_frame) {
+      keys.push_back(key);
+    }
+  });
+  for (uint64_t key : keys) eraseVariant(key);
+}
+
+bool TextureCache::evictVariant() {
+  // Copies drawn this frame stay, built or not.
+  uint64_t victim = 0;
+  uint64_t oldest = m_frame;
+  m_variants.forEach([&](uint64_t key, const IconSlot& slot) {
+    if (slot.lastUse < oldest) {
+      oldest = slot.lastUse;
+      victim = key;
+    }
+  });
+  if (victim == 0) return false;
+
+  if (m_variants.find(victim)->state == SlotState::READY) {
+    ++m_stats.evictions;
+  }
+  eraseVariant(victim);
+  return true;
+}
+
+void TextureCache::eraseVariant(uint64_t key) {
+  if (IconSlot* slot = m_variants.find(key)) {
+    m_stats.residentBytes -= slot->bytes;
+    m_variants.erase(key);
+  }
+}
+
+void TextureCache::updateTexture(
+    const SP<CTexture>& tex,
+    int x,
+    int y,
+    const Image& image) {
+  // Draws already issued this frame still sample the old contents;
+  // the driver orders the upload after them.
+  glBindTexture(GL_TEXTURE_2D, tex->m_texID);
+  glTexSubImage2D(
+      GL_TEXTURE_2D, 0, x, y, image.w, image.h,
+      GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.data());
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// Copies an image surface's pixels, dropping the row padding.
+static void readSurface(
+    cairo_surface_t* surface,
+    int& w,
+    int& h,
+    std::vector<uint32_t>& pixels) {
+  w = cairo_image_surface_get_width(surface);
+  h = cairo_image_surface_get_height(surface);
+  const unsigned char* src = cairo_image_surface_get_data(surface);
+  int stride = cairo_image_surface_get_stride(surface);
+
+  pixels.resize((size_t)w * h);
+  for (int row = 0; row < h; ++row) {
+    std::memcpy(&pixels[(size_t)row * w], src + (size_t)row * stride,
+                (size_t)w * 4);
+  }
+}
+
+bool TextureCache::decodePng(const std::string& path, Image& out) {
   cairo_surface_t* surface =
       cairo_image_surface_create_from_png(path.c_str());
 
   if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
     cairo_surface_destroy(surface);
-    return nullptr;
+    return false;
   }
 
-  int w = cairo_image_surface_get_width(surface);
-  int h = cairo_image_surface_get_height(surface);
-  const auto data = cairo_image_surface_get_data(surface);
+  readSurface(surface, out.w, out.h, out.pixels);
+  cairo_surface_destroy(surface);
+  return true;
+}
 
-  SP<CTexture> tex = makeShared<CTexture>();
-  tex->allocate();
-  glBindTexture(GL_TEXTURE_2D, tex->m_texID);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+bool TextureCache::scaleImage(const Image& image, int w, int h, Image& out) {
+  // GOOD filters with a box kernel when shrinking, so every source
+  // pixel contributes rather than the few a bilinear tap lands on.
+  cairo_surface_t* source = cairo_image_surface_create_for_data(
+      (unsigned char*)image.pixels.data(), CAIRO_FORMAT_ARGB32, image.w,
+      image.h, image.w * 4);
+  cairo_surface_t* target =
+      cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h);
+  cairo_t* cr = cairo_create(target);
 
-#ifndef GLES2
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
-#endif
+  cairo_scale(cr, (double)w / image.w, (double)h / image.h);
+  cairo_set_source_surface(cr, source, 0, 0);
+  cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_GOOD);
+  cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+  cairo_paint(cr);
+  cairo_destroy(cr);
+  cairo_surface_flush(target);
 
-  glTexImage2D(
-      GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0,
-      GL_RGBA, GL_UNSIGNED_BYTE, data);
+  bool ok = cairo_surface_status(target) == CAIRO_STATUS_SUCCESS;
+  if (ok) readSurface(target, out.w, out.h, out.pixels);
+  cairo_surface_destroy(target);
+  cairo_surface_destroy(source);
+  return ok;
+}
 
-  cairo_surface_destroy(surface);
+void TextureCache::packAtlas(const std::string& dir, DecodeResult& result) {
+  struct Entry {
+    std::string path;
+    Image image;
+    int page = -1, x = 0, y = 0;
+  };
 
-  CachedTexture cached;
-  cached.texture = tex;
-  cached.size = {(double)w, (double)h};
-  m_cache[path] = cached;
+  std::vector<Entry> entries;
+  std::error_code ec;
+  for (const auto& file : std::filesystem::directory_iterator(dir, ec)) {
+    if (file.path().extension() != ".png") continue;
 
-  return tex;
+    Entry entry;
+    entry.path = file.path().string();
+    if (decodePng(entry.path, entry.image)) {
+      entries.push_back(std::move(entry));
+    }
+  }
+
+  // Shelf packing: tallest first, left to right, opening a new shelf
+  // when a row is full and a new page when the page is full.
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) {
+              return a.image.h > b.image.h;
+            });
+
+  const int size = config::ATLAS_PAGE_SIZE;
+  const int pad = config::ATLAS_PADDING;
+  std::vector<int> pageHeights;
+  int x = pad, y = pad, shelfHeight = 0;
+
+  for (auto& entry : entries) {
+    const Image& image = entry.image;
+    if (image.w + 2 * pad > size || image.h + 2 * pad > size) continue;
+
+    if (pageHeights.empty()) pageHeights.push_back(0);
+    if (x + image.w + pad > size) {
+      x = pad;
+      y += shelfHeight + pad;
+      shelfHeight = 0;
+    }
+    if (y + image.h + pad > size) {
+      pageHeights.push_back(0);
+      x = pad;
+      y = pad;
+      shelfHeight = 0;
+    }
+
+    entry.page = pageHeights.size() - 1;
+    entry.x = x;
+    entry.y = y;
+    x += image.w + pad;
+    shelfHeight = std::max(shelfHeight, image.h);
+    pageHeights.back() = std::max(pageHeights.back(), y + image.h + pad);
+  }
+
+  // Compose each page on the CPU, trimmed to the rows actually used,
+  // so the render thread only has to upload it.
+  for (size_t page = 0; page < pageHeights.size(); ++page) {
+    Image composed;
+    composed.w = size;
+    composed.h = pageHeights[page];
+    composed.pixels.assign((size_t)size * composed.h, 0);
+
+    for (const auto& entry : entries) {
+      if (entry.page != (int)page) continue;
+      const Image& image = entry.image;
+      for (int row = 0; row < image.h; ++row) {
+        std::memcpy(
+            &composed.pixels[(size_t)(entry.y + row) * size + entry.x],
+            &image.pixels[(size_t)row * image.w], (size_t)image.w * 4);
+      }
+      result.placements.push_back(
+          {entry.path, entry.page, entry.x, entry.y, image.w, image.h});
+    }
+    result.pages.push_back(std::move(composed));
+  }
 }
@@ -3,42 +3,278 @@
 #include <hyprland/src/render/OpenGL.hpp>
 #include <string>
 #include <unordered_map>
+#include <array>
+#include <vector>
 #include <mutex>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include "types.hpp"
+#include "flat-map.hpp"
+
+class DecodePool;
+
+/**
+ * A drawable sub-rectangle of a texture.
+ * Atlas icons share a page texture; standalone textures span 0..1.
+ */
+struct TextureRegion {
+  SP<CTexture> texture;
+  Vector2D uvTopLeft = {0, 0};
+  Vector2D uvBottomRight = {1, 1};
+  Vector2D size;  // Pixel size of the icon itself
+};
+
+/**
+ * Counters describing cache behaviour, for sizing the budget.
+ */
+struct TextureStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  uint64_t decodes = 0;
+  double decodeMs = 0;  // Total worker time spent decoding
+  size_t residentBytes = 0;
+  size_t residentIcons = 0;
+  size_t residentVariants = 0;
+  size_t budgetBytes = 0;
+};
 
 /**
- * Caches OpenGL textures loaded from PNG files.
- * Thread-safe singleton for texture management.
+ * Caches OpenGL textures for overlay icons.
+ *
+ * PNG decoding runs on a small DecodePool; only the GL upload
+ * happens on the render thread, in uploadPending(). An icon that is
+ * still decoding is simply not drawn, and the ready callback lets
+ * the owner damage windows once it can be.
+ *
+ * In atlas mode every PNG in the icon directory is packed into one
+ * or a few page textures by a single background job, so overlays on
+ * a window can be drawn by IconBatch with a single bind.
+ *
+ * Files that change on disk are re-decoded one by one and uploaded
+ * over their old texture or atlas slot; only a size change forces a
+ * repack, which is swapped in once it is ready.
+ *
+ * Icons drawn smaller than their PNG get a variant per pixel size,
+ * downscaled with cairo's GOOD filter on a worker, so the draw
+ * samples a texture matching its footprint on every monitor scale.
+ * The full-size icon is drawn scaled until the variant is ready.
+ * At MAX_ICON_VARIANTS the copy unused the longest makes room, and
+ * copies not drawn for VARIANT_IDLE_FRAMES are dropped.
+ *
+ * Standalone textures and variants are kept under a byte budget and
+ * evicted least-recently-used first; an evicted icon is decoded
+ * again on its next use. Atlas pages and pinned icons are never
+ * evicted.
+ *
+ * Slots are only touched by the compositor main thread; workers
+ * hand results back through a mutex-guarded list.
  */
 class TextureCache {
  public:
+  using ReadyCallback = std::function<void()>;
+
   static TextureCache& get();
 
   /**
-   * Loads a texture from path, returning cached version if available.
-   * Returns nullptr on failure.
+   * Returns the region for an icon, or nullptr if it is still
+   * decoding or could not be loaded. A first request queues the
+   * decode. Failed icons are not retried until clear().
+   */
+  const TextureRegion* region(IconId icon);
+
+  /**
+   * Returns the region for an icon if it is resident, for sizing
+   * damage. Unlike region() it queues nothing and leaves the stats
+   * and LRU order alone, which follow what is drawn.
+   */
+  const TextureRegion* peek(IconId icon);
+
+  /**
+   * Returns a copy of a resident icon prescaled to pixelSize, or
+   * nullptr if the icon itself should be drawn: when it is not being
+   * shrunk, or while the copy is built. The pointer is only valid
+   * until the next call.
+   */
+  const TextureRegion* variant(IconId icon, const Vector2D& pixelSize);
+
+  /**
+   * Returns the id of an icon file in the icon directory by base
+   * name, registering it on first use so later lookups skip path
+   * resolution. Safe from any thread. Returns NONE for names outside
+   * the directory or when the table is full.
+   */
+  IconId intern(const std::string& name);
+
+  /**
+   * Sets the directory intern() resolves names in. Names interned
+   * before keep their path.
+   */
+  void setIconDir(const std::string& dir);
+
+  /**
+   * Queues an icon for background decoding ahead of its first use.
+   */
+  void prefetch(IconId icon);
+
+  /**
+   * Uploads finished decodes. Must run with the GL context current.
+   */
+  void uploadPending();
+
+  /**
+   * Re-resolves icons whose configured path changed. The old
+   * textures stay drawable until the new files are decoded.
+   */
+  void invalidate(const std::vector<IconId>& icons);
+
+  /**
+   * Records icon files that changed on disk. Safe from any thread;
+   * nothing is decoded until reloadStale().
    */
-  SP<CTexture> load(const std::string& path);
+  void markStale(const std::vector<std::string>& paths);
 
   /**
-   * Gets the size of a loaded texture.
+   * Re-decodes files passed to markStale(). Each is uploaded in place
+   * over its old texture or atlas slot when its size is unchanged;
+   * until then the old pixels keep being drawn.
    */
-  Vector2D getSize(const std::string& path);
+  void reloadStale();
 
   /**
-   * Clears all cached textures.
+   * Starts a new frame. Icons used during the current frame are
+   * never evicted.
+   */
+  void beginFrame();
+
+  /**
+   * Keeps a built-in icon resident regardless of the budget.
+   */
+  void setPinned(IconId icon, bool pinned);
+
+  /**
+   * Sets the byte budget for textures and evicts down to it.
+   */
+  void setBudget(size_t bytes);
+
+  /**
+   * Returns a copy of the current counters.
+   */
+  TextureStats stats() const;
+
+  /**
+   * Sets the callback run on a worker thread after a decode finishes.
+   */
+  void setReadyCallback(ReadyCallback callback);
+
+  /**
+   * Gets the pixel size of a resident icon, or {0, 0}.
+   */
+  Vector2D getSize(IconId icon);
+
+  /**
+   * Clears all cached textures. In-flight decodes are discarded.
    */
   void clear();
 
  private:
-  TextureCache() = default;
+  TextureCache();
+  ~TextureCache();
+
+  enum class SlotState : uint8_t { EMPTY, PENDING, READY, FAILED };
+
+  struct IconSlot {
+    TextureRegion region;
+    SlotState state = SlotState::EMPTY;
+    size_t bytes = 0;      // Standalone texture size; 0 if in the atlas
+    uint64_t lastUse = 0;  // Frame of the last region() hit
+    uint64_t variantRetry = 0;  // No variants built before this frame
+  };
+
+  struct Image {
+    int w = 0, h = 0;
+    std::vector<uint32_t> pixels;  // Premultiplied ARGB, tightly packed
+  };
+
+  struct Placement {
+    std::string path;
+    int page = -1, x = 0, y = 0, w = 0, h = 0;
+  };
 
-  SP<CTexture> loadFromFile(const std::string& path);
+  struct AtlasEntry {
+    TextureRegion region;
+    int x = 0, y = 0;  // Pixel offset within the page
+  };
+
+  enum class ResultKind : uint8_t { ICON, ATLAS, RELOAD, VARIANT };
 
-  struct CachedTexture {
-    SP<CTexture> texture;
-    Vector2D size;
+  struct DecodeResult {
+    uint64_t generation = 0;
+    ResultKind kind = ResultKind::ICON;
+    IconId icon = IconId::NONE;
+    uint64_t variant = 0;              // Key of a prescaled copy
+    std::string path;                  // Reloaded file
+    Image image;                       // Standalone or reloaded icon
+    std::vector<Image> pages;          // Atlas pages
+    std::vector<Placement> placements;
   };
 
-  std::unordered_map<std::string, CachedTexture> m_cache;
-  std::mutex m_mutex;
+  static bool decodePng(const std::string& path, Image& out);
+  static bool scaleImage(const Image& image, int w, int h, Image& out);
+  static uint64_t variantKey(IconId icon, int w, int h);
+  static void packAtlas(const std::string& dir, DecodeResult& result);
+
+  IconSlot* slotFor(IconId icon);
+  std::string pathOf(IconId icon);
+  void request(IconId icon);
+  void requestAtlas();
+  void requestStandalone(IconId icon);
+  void requestVariant(IconId icon, uint64_t key, int w, int h);
+  void submit(std::function<void(DecodeResult&)> job);
+  void applyResult(DecodeResult& result);
+  void applyIcon(IconSlot& slot, const Image& image);
+  void applyAtlas(DecodeResult& result);
+  void applyReload(DecodeResult& result);
+  void applyVariant(DecodeResult& result);
+  void dropVariants(IconId icon);
+  void dropIdleVariants();
+  bool evictVariant();
+  void eraseVariant(uint64_t key);
+  void updateTexture(
+      const SP<CTexture>& tex, int x, int y, const Image& image);
+  void evictToBudget();
+
+  enum class AtlasState : uint8_t { NONE, PENDING, READY };
+
+  std::vector<IconSlot> m_icons;  // Built-in ids, then interned ones
+  FlatMap<uint64_t, IconSlot> m_variants;
+  std::vector<SP<CTexture>> m_atlasPages;
+  std::unordered_map<std::string, AtlasEntry> m_atlasRegions;
+  size_t m_atlasBytes = 0;
+  AtlasState m_atlasState = AtlasState::NONE;
+  bool m_atlasQueued = false;  // A pack job is in flight
+  bool m_atlasStale = false;   // Files changed while it was
+  uint64_t m_generation = 0;
+
+  std::array<bool, (size_t)IconId::COUNT> m_pinned = {};
+  uint64_t m_frame = 1;
+  int m_variantBuilds = 0;  // Started this frame
+  TextureStats m_stats;
+  std::atomic<uint64_t> m_decodes{0};
+  std::atomic<uint64_t> m_decodeNs{0};
+
+  std::mutex m_namesMutex;  // Guards the interned icon tables
+  // intern() runs on parser threads, which must not read the
+  // main-thread settings table; it reads this copy instead.
+  std::atomic<std::shared_ptr<const std::string>> m_iconDir;
+  std::unordered_map<std::string, IconId> m_dynamicIds;
+  std::vector<std::string> m_dynamicPaths;
+
+  std::unique_ptr<DecodePool> m_pool;
+  std::mutex m_resultMutex;
+  std::vector<DecodeResult> m_results;
+  std::vector<std::string> m_stalePaths;
+  std::atomic<bool> m_hasResults{false};
+  ReadyCallback m_readyCallback;
 };
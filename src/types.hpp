@@ -3,6 +3,14 @@
 #include <string>
 #include <chrono>
 #include <vector>
+#include <array>
+#include <cstdint>
+
+/**
+ * Window identity used by all overlay state: the CWindow address,
+ * parsed once from the hex string clients send.
+ */
+using WindowHandle = uintptr_t;
 
 /**
  * Overlay position on the window.
@@ -29,15 +37,32 @@ enum class OverlayType {
   SCROLL_ANCHOR
 };
 
+/**
+ * Identifies an icon file in the icon directory.
+ * Resolved to a path at config load (see settings::iconPath) so the
+ * render path only passes small integers around.
+ */
+enum class IconId : uint16_t {
+  NONE,
+  VOLUME_UP,
+  VOLUME_DOWN,
+  MUTE,
+  ANCHOR,
+  ANCHOR_UP,
+  ANCHOR_DOWN,
+  VOLUME_0,  // volume_0.png; volume_1..volume_13 follow
+  COUNT = VOLUME_0 + 14
+};
+
 /**
  * Configuration for a single overlay type.
  */
 struct OverlayConfig {
-  std::string iconPath;
+  IconId icon = IconId::NONE;
   Position position = Position::CENTER;
   int displayMs = 800;
   int fadeMs = 100;
-  int iconSize = 128;
+  int iconSize = 0;  // Largest side in pixels; 0 keeps the native size
   int padding = 10;
 };
 
@@ -59,7 +84,7 @@ struct OverlayEvent {
 struct OverlayInfo {
   OverlayType type = OverlayType::NONE;
   float opacity = 0.0f;
-  std::string iconPath;
+  IconId icon = IconId::NONE;
   int volumeLevel = 0;  // 0-100 percentage
   // Position override (if set, ignores standard layout)
   bool hasCustomPos = false;
@@ -67,6 +92,28 @@ struct OverlayInfo {
   double y = 0;
 };
 
+/**
+ * Overlays visible on one window for one frame.
+ * Built once per frame against a single timestamp and shared by
+ * draw, renderPass and getVisualBox. Inline storage, no allocation.
+ */
+struct OverlaySnapshot {
+  static constexpr size_t MAX_OVERLAYS = 8;
+
+  std::array<OverlayInfo, MAX_OVERLAYS> items;
+  size_t count = 0;
+  std::chrono::steady_clock::time_point time;
+
+  bool empty() const { return count == 0; }
+  const OverlayInfo* begin() const { return items.data(); }
+  const OverlayInfo* end() const { return items.data() + count; }
+
+  void clear() { count = 0; }
+  void push(const OverlayInfo& info) {
+    if (count < MAX_OVERLAYS) items[count++] = info;
+  }
+};
+
 /**
  * Parses position string to enum.
  */
@@ -94,3 +141,19 @@ inline std::string positionToString(Position pos) {
     default: return "center";
   }
 }
+
+/**
+ * Severity of a log message; OFF as a threshold silences everything.
+ */
+enum class LogLevel : uint8_t { DEBUG, INFO, WARN, ERROR, OFF };
+
+/**
+ * Parses a log level name. Unknown names mean INFO.
+ */
+inline LogLevel parseLogLevel(const std::string& str) {
+  if (str == "debug") return LogLevel::DEBUG;
+  if (str == "warn") return LogLevel::WARN;
+  if (str == "error") return LogLevel::ERROR;
+  if (str == "off") return LogLevel::OFF;
+  return LogLevel::INFO;
+}
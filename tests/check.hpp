@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+/**
+ * Just enough of a test harness for the core unit tests. No framework
+ * dependency, so the suite builds wherever superglue_core does.
+ */
+namespace check {
+
+struct Test {
+  const char* name;
+  void (*fn)();
+};
+
+inline std::vector<Test>& registry() {
+  static std::vector<Test> tests;
+  return tests;
+}
+
+inline int& failures() {
+  static int count = 0;
+  return count;
+}
+
+struct Register {
+  Register(const char* name, void (*fn)()) {
+    registry().push_back({name, fn});
+  }
+};
+
+inline void fail(const char* file, int line, const char* expr) {
+  std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expr);
+  ++failures();
+}
+
+}  // namespace check
+
+#define TEST(name)                                        \
+  static void name();                                     \
+  static check::Register name##Registration(#name, name); \
+  static void name()
+
+#define CHECK(expr) \
+  ((expr) ? (void)0 : check::fail(__FILE__, __LINE__, #expr))
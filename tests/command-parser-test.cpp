@@ -0,0 +1,213 @@
+// CommandParser: what each verb accepts and rejects, and the records
+// it produces.
+
+#include "check.hpp"
+#include "command-parser.hpp"
+#include "metrics.hpp"
+#include "primitive.hpp"
+#include <map>
+#include <vector>
+
+namespace {
+
+constexpr WindowHandle WINDOW = 0x55d0c0001a40;
+
+// A parser whose hooks record what they were given, collecting every
+// record it emits.
+struct Fixture {
+  std::vector<std::string> icons;
+  std::vector<std::string> texts;
+  std::vector<std::string> logs;
+  bool textFull = false;
+  CommandParser parser{{
+      [this](std::string_view name) {
+        icons.emplace_back(name);
+        return (IconId)((size_t)IconId::COUNT + icons.size() - 1);
+      },
+      [this](std::string text) -> std::optional<uint32_t> {
+        if (textFull) return std::nullopt;
+        texts.push_back(std::move(text));
+        return texts.size() - 1;
+      },
+      [this](const std::string& msg) { logs.push_back(msg); },
+  }};
+
+  std::vector<OverlayCommand> records;
+  std::vector<TraceId> traces;
+
+  void parse(std::string_view content) {
+    parser.parse(content, [this](const OverlayCommand& cmd, TraceId trace) {
+      records.push_back(cmd);
+      traces.push_back(trace);
+    });
+  }
+
+  // Parses one line and returns whether it was accepted.
+  bool accepts(std::string_view line) {
+    uint64_t before = parser.rejected();
+    parse(line);
+    return parser.rejected() == before;
+  }
+};
+
+// Whether every line is rejected and counted against op.
+bool rejects(CommandOp op, std::vector<std::string_view> lines) {
+  Fixture f;
+  uint64_t before = Metrics::get().rejected(op);
+  for (auto line : lines) f.parse(line);
+  return f.records.empty() && f.parser.rejected() == lines.size() &&
+         Metrics::get().rejected(op) == before + lines.size();
+}
+
+}  // namespace
+
+TEST(volumeVerbs) {
+  const std::map<std::string_view, CommandOp> verbs = {
+      {"vol-up", CommandOp::VOLUME_UP},
+      {"vol-down", CommandOp::VOLUME_DOWN},
+      {"volume", CommandOp::VOLUME_LEVEL},  // Any other name
+  };
+  for (auto [verb, op] : verbs) {
+    Fixture f;
+    CHECK(f.accepts(std::string(verb) + " 0x55d0c0001a40 +80"));
+    CHECK(f.records.size() == 1);
+    CHECK(f.records[0].op == op);
+    CHECK(f.records[0].window == WINDOW);
+    CHECK(f.records[0].level == 80);
+
+    CHECK(rejects(op, {
+        std::string(verb),
+        std::string(verb) + " 55d0c0001a40",
+        std::string(verb) + " 0 80",
+        std::string(verb) + " zz 80",
+        std::string(verb) + " 55d0c0001a40 80%",
+        std::string(verb) + " 55d0c0001a40 99999999999",
+    }));
+  }
+}
+
+TEST(scrollVerbs) {
+  Fixture f;
+  CHECK(f.accepts("scroll-start 55d0c0001a40 1920.5 -8"));
+  CHECK(f.accepts("scroll-stop 55d0c0001a40"));
+  CHECK(f.records.size() == 2);
+  CHECK(f.records[0].op == CommandOp::SCROLL_START);
+  CHECK(f.records[0].x == 1920.5 && f.records[0].y == -8);
+  CHECK(f.records[1].op == CommandOp::SCROLL_STOP);
+  CHECK(f.records[1].window == WINDOW);
+
+  CHECK(rejects(CommandOp::SCROLL_START, {
+      "scroll-start 55d0c0001a40",
+      "scroll-start 55d0c0001a40 10",
+      "scroll-start 55d0c0001a40 10 y",
+      "scroll-start x 10 10",
+  }));
+  CHECK(rejects(CommandOp::SCROLL_STOP, {"scroll-stop", "scroll-stop 0x"}));
+}
+
+TEST(createEmitsFieldsInOrder) {
+  Fixture f;
+  CHECK(f.accepts("create 7 55d0c0001a40 progress x=20 value=0.3 "
+                  "color=#ff0000 background=#00000066 bogus=1 w=oops"));
+  CHECK(f.records.size() == 5);
+  CHECK(f.records[0].op == CommandOp::PRIM_CREATE);
+  CHECK(f.records[0].level == 7);
+  CHECK(f.records[0].window == WINDOW);
+  CHECK(f.records[0].flags == (uint16_t)PrimitiveKind::PROGRESS);
+
+  for (size_t i = 1; i < f.records.size(); ++i) {
+    CHECK(f.records[i].op == CommandOp::PRIM_SET);
+    CHECK(f.records[i].level == 7);
+  }
+  CHECK(f.records[1].flags == (uint16_t)PrimitiveField::X);
+  CHECK(f.records[1].x == 20);
+  CHECK(f.records[2].flags == (uint16_t)PrimitiveField::VALUE);
+  CHECK(f.records[3].flags == (uint16_t)PrimitiveField::COLOR);
+  CHECK(f.records[3].x == 0xff0000ff);  // No alpha means opaque
+  CHECK(f.records[4].flags == (uint16_t)PrimitiveField::BACKGROUND);
+  CHECK(f.records[4].x == 0x00000066);
+  CHECK(f.logs.size() == 2);  // Unknown field and bad number
+
+  CHECK(rejects(CommandOp::PRIM_CREATE, {
+      "create",
+      "create 0 55d0c0001a40 rect",
+      "create -3 55d0c0001a40 rect",
+      "create 7 55d0c0001a40",
+      "create 7 0 rect",
+      "create 7 55d0c0001a40 hexagon",
+  }));
+}
+
+TEST(updateCarriesOnlyNamedFields) {
+  Fixture f;
+  CHECK(f.accepts("update 10 icon=volume_5 size=18 text=47% of  max"));
+  CHECK(f.records.size() == 3);
+  CHECK(f.records[0].flags == (uint16_t)PrimitiveField::ICON);
+  CHECK(f.icons == std::vector<std::string>{"volume_5"});
+  CHECK(f.records[0].x == (double)IconId::COUNT);
+  CHECK(f.records[1].flags == (uint16_t)PrimitiveField::SIZE);
+
+  // text= takes the rest of the line, spaces included.
+  CHECK(f.records[2].flags == (uint16_t)PrimitiveField::TEXT);
+  CHECK(f.texts == std::vector<std::string>{"47% of  max"});
+  CHECK(f.records[2].x == 0);
+
+  // A label that can't be kept is dropped, not the line.
+  f.textFull = true;
+  CHECK(f.accepts("update 10 text=lost"));
+  CHECK(f.records.size() == 3);
+  CHECK(f.logs.size() == 1);
+
+  CHECK(rejects(CommandOp::PRIM_SET, {"update", "update x", "update 0"}));
+}
+
+TEST(destroyTakesOnlyAnId) {
+  Fixture f;
+  CHECK(f.accepts("destroy 7 x=1"));
+  CHECK(f.records.size() == 1);
+  CHECK(f.records[0].op == CommandOp::PRIM_DESTROY);
+  CHECK(f.records[0].level == 7);
+  CHECK(rejects(CommandOp::PRIM_DESTROY, {"destroy", "destroy 7.5"}));
+}
+
+TEST(linesAndTags) {
+  Fixture f;
+  f.parse("vol-up 1 10\r\n\n   \t\r\n@5:0 vol-down 2 20");
+  CHECK(f.parser.rejected() == 0);
+  CHECK(f.records.size() == 2);
+  CHECK(f.traces[0] == 0);
+  CHECK(f.traces[1] != 0);
+  CHECK(f.records[1].window == 2 && f.records[1].level == 20);
+
+  // A malformed tag rejects its line rather than being skipped.
+  for (auto line : {"@x vol-up 3 30", "@ vol-up 3 30", "@5: vol-up 3 30",
+                    "@5:x vol-up 3 30", "@-5 vol-up 3 30"}) {
+    CHECK(!f.accepts(line));
+  }
+  CHECK(f.records.size() == 2);
+}
+
+TEST(signedNumbers) {
+  Fixture f;
+  CHECK(f.accepts("vol-up 1 +5"));
+  CHECK(f.accepts("vol-up 1 -5"));
+  CHECK(f.accepts("scroll-start 1 +1.5 -2"));
+  CHECK(f.records.size() == 3);
+  CHECK(f.records[0].level == 5 && f.records[1].level == -5);
+  CHECK(f.records[2].x == 1.5 && f.records[2].y == -2);
+
+  // A '+' is only stripped before digits.
+  CHECK(rejects(CommandOp::VOLUME_UP, {
+      "vol-up 1 +-5", "vol-up 1 ++5", "vol-up 1 +", "vol-up +-1 5"}));
+  CHECK(rejects(CommandOp::SCROLL_START, {"scroll-start 1 +-1 2"}));
+}
+
+TEST(parseAddress) {
+  CHECK(CommandParser::parseAddress("0x55d0c0001a40") == WINDOW);
+  CHECK(CommandParser::parseAddress("0X55D0C0001A40") == WINDOW);
+  CHECK(CommandParser::parseAddress("55d0c0001a40") == WINDOW);
+  CHECK(CommandParser::parseAddress("") == 0);
+  CHECK(CommandParser::parseAddress("0x") == 0);
+  CHECK(CommandParser::parseAddress("55d0g") == 0);
+  CHECK(CommandParser::parseAddress("10000000000000000") == 0);
+}
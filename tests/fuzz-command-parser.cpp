@@ -0,0 +1,31 @@
+// libFuzzer target: arbitrary bytes through CommandParser::parse, with
+// every record applied to a fresh OverlayModel.
+
+#include "clock.hpp"
+#include "command-parser.hpp"
+#include "overlay-model.hpp"
+#include <cstddef>
+#include <cstdint>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  ManualClock clock;
+  OverlayModel model(clock, nullptr, nullptr);
+
+  // Icon ids come from the name, so dynamic ids past the table reach
+  // the model too.
+  CommandParser parser({
+      [](std::string_view name) {
+        return (IconId)(name.size() % ((size_t)IconId::COUNT + 300));
+      },
+      [&model](std::string text) { return model.storeText(std::move(text)); },
+      nullptr,
+  });
+
+  std::string_view content(reinterpret_cast<const char*>(data), size);
+  parser.parse(content, [&](const OverlayCommand& command, TraceId) {
+    model.apply(command);
+    clock.advance(std::chrono::milliseconds(command.level & 0xff));
+  });
+  model.tick(std::chrono::milliseconds(16));
+  return 0;
+}
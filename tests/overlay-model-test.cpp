@@ -0,0 +1,310 @@
+// OverlayModel against a ManualClock: fade and expiry timing, tick()
+// wakeups, the primitive lifecycle and checks on client values.
+
+#include "check.hpp"
+#include "clock.hpp"
+#include "overlay-model.hpp"
+#include "settings.hpp"
+#include <cmath>
+#include <limits>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr WindowHandle WINDOW = 0x55d0c0001a40;
+constexpr auto FRAME = 16ms;
+
+// A model on a clock that only moves when told to, recording every
+// wakeup it asks for. Display and fade times are pinned so the tests
+// don't follow the defaults.
+struct Fixture {
+  ManualClock clock{Clock::TimePoint{} + 1h};
+  std::vector<Clock::TimePoint> wakes;
+  OverlayModel model{
+      clock, [this](Clock::TimePoint when) { wakes.push_back(when); },
+      nullptr};
+
+  Fixture() {
+    auto table = settings::defaults("/nonexistent");
+    for (auto& type : table.types) {
+      type.displayMs = 800;
+      type.fadeMs = 100;
+    }
+    settings::install(std::move(table));
+  }
+
+  size_t visible() {
+    OverlaySnapshot snapshot;
+    model.buildSnapshot(WINDOW, clock.now(), snapshot);
+    return snapshot.count;
+  }
+
+  const Primitive* primitive() {
+    const Primitive* found = nullptr;
+    model.forEachPrimitive(
+        WINDOW, clock.now(), [&found](const Primitive& p) { found = &p; });
+    return found;
+  }
+};
+
+OverlayCommand command(CommandOp op, WindowHandle window, int32_t level) {
+  OverlayCommand cmd;
+  cmd.op = op;
+  cmd.window = window;
+  cmd.level = level;
+  return cmd;
+}
+
+OverlayCommand create(int32_t id, PrimitiveKind kind) {
+  OverlayCommand cmd = command(CommandOp::PRIM_CREATE, WINDOW, id);
+  cmd.flags = (uint16_t)kind;
+  return cmd;
+}
+
+OverlayCommand set(int32_t id, PrimitiveField field, double value) {
+  OverlayCommand cmd = command(CommandOp::PRIM_SET, 0, id);
+  cmd.flags = (uint16_t)field;
+  cmd.x = value;
+  return cmd;
+}
+
+}  // namespace
+
+TEST(volumeEventFadesThenExpires) {
+  Fixture f;
+  auto start = f.clock.now();
+  f.model.apply(command(CommandOp::VOLUME_UP, WINDOW, 40));
+
+  // Level and arrow, fully opaque, with a wakeup when the fade starts.
+  CHECK(f.visible() == 2);
+  CHECK(!f.wakes.empty() && f.wakes.front() == start + 800ms);
+
+  OverlayEvent event;
+  event.type = OverlayType::VOLUME_LEVEL;
+  event.startTime = start;
+  CHECK(OverlayModel::opacity(event, start + 799ms) == 1.0f);
+  CHECK(std::abs(OverlayModel::opacity(event, start + 850ms) - 0.5f) < 1e-6);
+  CHECK(OverlayModel::opacity(event, start + 900ms) == 0.0f);
+
+  f.clock.advance(850ms);
+  CHECK(f.visible() == 2);
+  f.clock.advance(50ms);
+  CHECK(f.visible() == 0);
+}
+
+TEST(tickWakesAtFadeStartThenEveryFrame) {
+  Fixture f;
+  auto start = f.clock.now();
+  f.model.apply(command(CommandOp::VOLUME_LEVEL, WINDOW, 70));
+  f.model.dirtyWindows().clear();
+
+  // Nothing changes on screen until the fade starts.
+  auto next = f.model.tick(FRAME);
+  CHECK(next && *next == start + 800ms);
+  CHECK(f.model.dirtyWindows().empty());
+
+  f.clock.set(start + 800ms);
+  next = f.model.tick(FRAME);
+  CHECK(next && *next == f.clock.now() + FRAME);
+  CHECK(f.model.dirtyWindows().contains(WINDOW));
+
+  // One last repaint when the fade ends, then no more ticks.
+  f.model.dirtyWindows().clear();
+  f.clock.set(start + 900ms);
+  next = f.model.tick(FRAME);
+  CHECK(!next);
+  CHECK(f.model.dirtyWindows().contains(WINDOW));
+  CHECK(f.visible() == 0);
+  CHECK(!f.model.tick(FRAME));
+}
+
+TEST(primitiveCreateUpdateDestroy) {
+  Fixture f;
+  f.model.apply(create(7, PrimitiveKind::RECT));
+  CHECK(f.model.hasPrimitives(WINDOW));
+  CHECK(f.model.dirtyWindows().contains(WINDOW));
+
+  // Updates change the primitive in place.
+  f.model.dirtyWindows().clear();
+  const Primitive* before = f.primitive();
+  f.model.apply(set(7, PrimitiveField::X, 12));
+  f.model.apply(set(7, PrimitiveField::ALPHA, 3.0));
+  CHECK(f.primitive() == before);
+  CHECK(f.primitive()->x == 12);
+  CHECK(f.primitive()->alpha == 1.0f);
+  CHECK(f.model.dirtyWindows().contains(WINDOW));
+
+  // Creating an existing id replaces it.
+  f.model.apply(create(7, PrimitiveKind::CIRCLE));
+  size_t count = 0;
+  f.model.forEachPrimitive(
+      WINDOW, f.clock.now(), [&count](const Primitive&) { ++count; });
+  CHECK(count == 1);
+  CHECK(f.primitive()->kind == PrimitiveKind::CIRCLE);
+  CHECK(f.primitive()->x == 0);
+
+  f.model.apply(command(CommandOp::PRIM_DESTROY, 0, 7));
+  CHECK(!f.model.hasPrimitives(WINDOW));
+  f.model.apply(set(7, PrimitiveField::X, 1));  // Gone: ignored
+  CHECK(!f.model.hasPrimitives(WINDOW));
+}
+
+TEST(primitiveTtlExpires) {
+  Fixture f;
+  auto start = f.clock.now();
+  f.model.apply(create(3, PrimitiveKind::PROGRESS));
+  f.model.apply(set(3, PrimitiveField::TTL, 500));
+  CHECK(!f.wakes.empty() && f.wakes.back() == start + 500ms);
+  CHECK(f.model.tick(FRAME) == start + 500ms);
+
+  f.clock.advance(499ms);
+  CHECK(f.primitive() != nullptr);
+  f.clock.advance(1ms);
+  CHECK(f.primitive() == nullptr);  // Hidden as soon as it expires
+
+  f.model.dirtyWindows().clear();
+  CHECK(!f.model.tick(FRAME));
+  CHECK(!f.model.hasPrimitives(WINDOW));
+  CHECK(f.model.dirtyWindows().contains(WINDOW));
+
+  // ttl=0 lives until destroyed.
+  f.model.apply(create(4, PrimitiveKind::RECT));
+  f.model.apply(set(4, PrimitiveField::TTL, 0));
+  f.clock.advance(24h);
+  CHECK(!f.model.tick(FRAME));
+  CHECK(f.model.hasPrimitives(WINDOW));
+}
+
+TEST(badFieldValuesAreRejected) {
+  Fixture f;
+  f.model.apply(create(5, PrimitiveKind::ICON));
+  f.model.apply(set(5, PrimitiveField::COLOR, 0x11223344));
+  f.model.dirtyWindows().clear();
+
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const double inf = std::numeric_limits<double>::infinity();
+  for (double value : {nan, inf, -1.0, 1e20}) {
+    f.model.apply(set(5, PrimitiveField::COLOR, value));
+    f.model.apply(set(5, PrimitiveField::ICON, value));
+  }
+  f.model.apply(set(5, PrimitiveField::X, inf));
+  f.model.apply(set(5, PrimitiveField::Y, 1e300));
+  f.model.apply(set(5, PrimitiveField::TTL, 1e12));
+  f.model.apply(set(5, PrimitiveField::TEXT, 12345));
+
+  const Primitive* p = f.primitive();
+  CHECK(p->color == 0x11223344);
+  CHECK(p->icon == IconId::NONE);
+  CHECK(p->x == 0 && p->y == 0);
+  CHECK(p->expires == Primitive::TimePoint::max());
+  CHECK(f.model.dirtyWindows().empty());
+
+  // Unknown kinds are never created.
+  OverlayCommand bogus = create(6, PrimitiveKind::RECT);
+  bogus.flags = 99;
+  f.model.apply(bogus);
+  size_t count = 0;
+  f.model.forEachPrimitive(
+      WINDOW, f.clock.now(), [&count](const Primitive&) { ++count; });
+  CHECK(count == 1);
+}
+
+TEST(textHandlesAreSingleUse) {
+  Fixture f;
+  f.model.apply(create(9, PrimitiveKind::TEXT));
+
+  auto handle = f.model.storeText("42%");
+  CHECK(handle.has_value());
+  f.model.apply(set(9, PrimitiveField::TEXT, *handle));
+  CHECK(f.primitive()->text == "42%");
+
+  // A handle is spent once applied.
+  f.model.apply(set(9, PrimitiveField::TEXT, *handle));
+  CHECK(f.primitive()->text == "42%");
+
+  // Labels waiting to be applied are never overwritten: the table
+  // refuses more than it can hold.
+  std::vector<uint32_t> held;
+  while (auto next = f.model.storeText("held")) held.push_back(*next);
+  CHECK(held.size() == config::COMMAND_QUEUE_CAPACITY);
+
+  OverlayCommand dropped = set(9, PrimitiveField::TEXT, held.back());
+  f.model.releaseText(dropped);
+  auto reused = f.model.storeText("new");
+  CHECK(reused.has_value() && *reused != held.back());
+  f.model.apply(set(9, PrimitiveField::TEXT, held.front()));
+  CHECK(f.primitive()->text == "held");
+}
+
+TEST(removeWindowForgetsEverything) {
+  Fixture f;
+  OverlayCommand scroll = command(CommandOp::SCROLL_START, WINDOW, 0);
+  f.model.apply(scroll);
+  f.model.apply(command(CommandOp::VOLUME_UP, WINDOW, 10));
+  f.model.apply(command(CommandOp::MUTE_ADD, WINDOW, 0));
+  f.model.apply(create(1, PrimitiveKind::RECT));
+  CHECK(f.visible() == 4);
+
+  f.model.removeWindow(WINDOW);
+  CHECK(f.visible() == 0);
+  CHECK(!f.model.hasPrimitives(WINDOW));
+  CHECK(f.model.dirtyWindows().empty());
+  CHECK(!f.model.tick(FRAME));
+}
+
+TEST(muteClearDamagesMutedWindows) {
+  Fixture f;
+  f.model.apply(command(CommandOp::MUTE_ADD, WINDOW, 0));
+  f.model.dirtyWindows().clear();
+  f.model.apply(command(CommandOp::MUTE_CLEAR, 0, 0));
+  CHECK(f.model.dirtyWindows().contains(WINDOW));
+  CHECK(f.visible() == 0);
+}
+
+TEST(repaintDamagesPrimitiveWindows) {
+  // An icon primitive created before its icon decoded has to be
+  // redrawn once it has.
+  Fixture f;
+  f.model.apply(create(2, PrimitiveKind::ICON));
+  f.model.dirtyWindows().clear();
+  f.model.markAllVisibleDirty();
+  CHECK(f.model.dirtyWindows().contains(WINDOW));
+
+  f.model.apply(command(CommandOp::PRIM_DESTROY, 0, 2));
+  f.model.dirtyWindows().clear();
+  f.model.markAllVisibleDirty();
+  CHECK(f.model.dirtyWindows().empty());
+}
+
+TEST(targetWindowFollowsPrimitives) {
+  Fixture f;
+  constexpr WindowHandle OTHER = 0x55d0c0002b80;
+  CHECK(f.model.targetWindow(command(CommandOp::VOLUME_UP, OTHER, 5)) ==
+        OTHER);
+
+  f.model.apply(create(4, PrimitiveKind::RECT));
+  CHECK(f.model.targetWindow(set(4, PrimitiveField::X, 1)) == WINDOW);
+  CHECK(f.model.targetWindow(command(CommandOp::PRIM_DESTROY, 0, 4)) ==
+        WINDOW);
+  CHECK(f.model.targetWindow(set(5, PrimitiveField::X, 1)) == 0);
+}
+
+TEST(tickDropsFinishedEvents) {
+  // Without a snapshot in between, as for a window that isn't drawn.
+  Fixture f;
+  f.model.apply(command(CommandOp::VOLUME_UP, WINDOW, 30));
+  f.clock.advance(900ms);
+  f.model.dirtyWindows().clear();
+  CHECK(!f.model.tick(FRAME));
+  CHECK(f.model.dirtyWindows().contains(WINDOW));
+
+  // A later tick, say for a primitive elsewhere, leaves it alone.
+  f.model.dirtyWindows().clear();
+  f.model.apply(command(CommandOp::PRIM_CREATE, 0x1234, 1));
+  f.model.apply(set(1, PrimitiveField::TTL, 100));
+  f.model.dirtyWindows().clear();
+  CHECK(f.model.tick(FRAME));
+  CHECK(f.model.dirtyWindows().empty());
+  CHECK(f.visible() == 0);
+}
@@ -0,0 +1,16 @@
+// Runs every registered test; exits non-zero if any check failed.
+
+#include "check.hpp"
+
+int main() {
+  int failed = 0;
+  for (const auto& test : check::registry()) {
+    int before = check::failures();
+    test.fn();
+    bool ok = check::failures() == before;
+    std::printf("%s %s\n", ok ? "ok  " : "FAIL", test.name);
+    failed += !ok;
+  }
+  std::printf("%zu tests, %d failed\n", check::registry().size(), failed);
+  return failed == 0 ? 0 : 1;
+}